@@ -0,0 +1,4377 @@
+#include "core/PDA_Core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "core/PDA_StructuralScanner.h"
+
+// ===== HORA LOCAL PORTABLE =====
+
+std::tm SafeLocalTime(std::time_t time) {
+    std::tm result{};
+#ifdef _WIN32
+    localtime_s(&result, &time);
+#else
+    localtime_r(&time, &result);
+#endif
+    return result;
+}
+
+// ===== PIPELINE DE LECTURA ÚNICA: EL JSON SE CARGA UNA VEZ Y SE COMPARTE =====
+
+bool LoadJsonFile(const fs::path& jsonPath, std::string& content, AsyncLog& logFile) {
+    content.clear();
+    try {
+        if (!fs::exists(jsonPath)) {
+            return false;
+        }
+
+        std::ifstream jsonFile(jsonPath, std::ios::binary);
+        if (!jsonFile.is_open()) {
+            logFile.error() << "ERROR: Cannot open JSON file: " << jsonPath.string() << std::endl;
+            return false;
+        }
+
+        jsonFile.seekg(0, std::ios::end);
+        size_t contentSize = jsonFile.tellg();
+        jsonFile.seekg(0, std::ios::beg);
+        content.resize(contentSize);
+        jsonFile.read(&content[0], contentSize);
+        jsonFile.close();
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in LoadJsonFile: " << e.what() << std::endl;
+        content.clear();
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in LoadJsonFile: Unknown exception" << std::endl;
+        content.clear();
+        return false;
+    }
+}
+
+// ===== VALIDADOR JSON DE UNA PASADA =====
+// Comprueba la gramática completa (objetos, arrays, cadenas con sus escapes, números y literales) en un
+// único recorrido, sin recursión: una pila guarda los contenedores abiertos. El primer error se
+// devuelve con su byte, línea y columna. Mientras recorre el objeto raíz registra dónde empieza y
+// termina el valor de cada miembro, que es el mismo índice que da IndexTopLevelSections.
+//
+// Dos tolerancias conservan el comportamiento de siempre: una coma justo antes de '}' o ']' sólo se
+// cuenta como aviso, y el contenido de las cadenas no se valida como UTF-8 (los nombres de plugins y
+// presets pueden venir en otras codificaciones).
+
+void LocateJsonOffset(std::string_view json, size_t offset, size_t& line, size_t& column) {
+    offset = std::min(offset, json.size());
+    std::string_view before = json.substr(0, offset);
+    line = static_cast<size_t>(std::count(before.begin(), before.end(), '\n')) + 1;
+    size_t lineStart = before.rfind('\n');
+    column = offset - (lineStart == std::string_view::npos ? 0 : lineStart + 1) + 1;
+}
+
+namespace {
+class JsonValidator {
+public:
+    explicit JsonValidator(std::string_view json) : json(json), size(json.size()) {}
+
+    JsonValidationResult run() {
+        result.sections.sections.reserve(8);
+
+        pos = skipWhitespace(0);
+        if (pos >= size || json[pos] != '{') {
+            fail(pos, "JSON root must be an object");
+            return std::move(result);
+        }
+
+        Expect expect = Expect::Value;
+        size_t pendingComma = SIZE_MAX;  // Coma que precede al elemento esperado
+
+        while (!failed) {
+            pos = skipWhitespace(pos);
+            if (pos >= size) {
+                if (expect != Expect::End) fail(size, "Unexpected end of JSON (unclosed object or array)");
+                break;
+            }
+            char c = json[pos];
+
+            switch (expect) {
+                case Expect::ValueOrClose:
+                    if (c == ']') {
+                        closeContainer(c);
+                        expect = afterValue();
+                        break;
+                    }
+                    [[fallthrough]];
+                case Expect::Value:
+                    if (c == ']' && pendingComma != SIZE_MAX && stack.back() == '[') {
+                        noteTrailingComma(pendingComma);
+                        pendingComma = SIZE_MAX;
+                        closeContainer(c);
+                        expect = afterValue();
+                        break;
+                    }
+                    pendingComma = SIZE_MAX;
+                    beginValue();
+                    if (c == '{' || c == '[') {
+                        stack.push_back(c);
+                        pos++;
+                        expect = (c == '{') ? Expect::KeyOrClose : Expect::ValueOrClose;
+                    } else if (parseScalar()) {
+                        endValue();
+                        expect = afterValue();
+                    }
+                    break;
+
+                case Expect::KeyOrClose:
+                    if (c == '}') {
+                        closeContainer(c);
+                        expect = afterValue();
+                        break;
+                    }
+                    [[fallthrough]];
+                case Expect::Key:
+                    if (c == '}' && pendingComma != SIZE_MAX) {
+                        noteTrailingComma(pendingComma);
+                        pendingComma = SIZE_MAX;
+                        closeContainer(c);
+                        expect = afterValue();
+                    } else if (c != '"') {
+                        fail(pos, c == ',' ? "Unexpected ',' (double comma)" : "Expected a string key or '}'");
+                    } else {
+                        pendingComma = SIZE_MAX;
+                        size_t keyStart = pos;
+                        if (parseString()) {
+                            if (stack.size() == 1) currentKey = json.substr(keyStart + 1, pos - keyStart - 2);
+                            expect = Expect::Colon;
+                        }
+                    }
+                    break;
+
+                case Expect::Colon:
+                    if (c != ':') {
+                        fail(pos, "Expected ':' after object key");
+                    } else {
+                        pos++;
+                        expect = Expect::Value;
+                    }
+                    break;
+
+                case Expect::CommaOrClose:
+                    if (c == ',') {
+                        pendingComma = pos++;
+                        expect = (stack.back() == '{') ? Expect::Key : Expect::Value;
+                    } else if (c == '}' || c == ']') {
+                        closeContainer(c);
+                        expect = afterValue();
+                    } else {
+                        fail(pos, stack.back() == '{' ? "Expected ',' or '}' after object member"
+                                                      : "Expected ',' or ']' after array element");
+                    }
+                    break;
+
+                case Expect::End:
+                    fail(pos, "Unexpected data after the end of the root object");
+                    break;
+            }
+        }
+
+        result.valid = !failed;
+        return std::move(result);
+    }
+
+private:
+    // Lo que la gramática admite en la posición actual (los *OrClose, justo tras abrir un contenedor)
+    enum class Expect { Value, ValueOrClose, Key, KeyOrClose, Colon, CommaOrClose, End };
+
+    Expect afterValue() const { return stack.empty() ? Expect::End : Expect::CommaOrClose; }
+
+    static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool IsHexDigit(char c) {
+        return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    size_t skipWhitespace(size_t at) const {
+        while (at < size && (json[at] == ' ' || json[at] == '\t' || json[at] == '\n' || json[at] == '\r')) at++;
+        return at;
+    }
+
+    void fail(size_t at, const char* message) {
+        if (failed) return;
+        failed = true;
+        result.error = message;
+        result.errorOffset = at;
+        LocateJsonOffset(json, at, result.errorLine, result.errorColumn);
+    }
+
+    void noteTrailingComma(size_t comma) {
+        if (comma == SIZE_MAX) return;
+        if (result.trailingCommas++ == 0) result.firstTrailingComma = comma;
+    }
+
+    // Un miembro del objeto raíz empieza o termina: así se construye el índice de secciones
+    void beginValue() {
+        if (stack.size() == 1) sectionStart = pos;
+    }
+
+    void endValue() {
+        if (stack.size() == 1) {
+            JsonSectionSpan& section = result.sections.sections.emplace_back();
+            section.key = currentKey;
+            section.valueStart = sectionStart;
+            section.valueEnd = pos;
+        }
+    }
+
+    void closeContainer(char c) {
+        char open = (c == '}') ? '{' : '[';
+        if (stack.back() != open) {
+            fail(pos, c == '}' ? "Mismatched '}' (expected ']')" : "Mismatched ']' (expected '}')");
+            return;
+        }
+        stack.pop_back();
+        pos++;
+        endValue();
+    }
+
+    bool parseScalar() {
+        char c = json[pos];
+        if (c == '"') return parseString();
+        if (c == '-' || IsDigit(c)) return parseNumber();
+        if (c == 't') return parseLiteral("true");
+        if (c == 'f') return parseLiteral("false");
+        if (c == 'n') return parseLiteral("null");
+        fail(pos, c == ',' ? "Unexpected ',' (double comma)" : "Expected a value");
+        return false;
+    }
+
+    // pos apunta a la comilla de apertura; termina un byte después de la de cierre
+    bool parseString() {
+        size_t open = pos++;
+        while (pos < size) {
+            unsigned char c = static_cast<unsigned char>(json[pos]);
+            if (c == '"') {
+                pos++;
+                return true;
+            }
+            if (c < 0x20) {
+                fail(pos, "Unescaped control character in string");
+                return false;
+            }
+            if (c != '\\') {
+                pos++;
+                continue;
+            }
+
+            if (pos + 1 >= size) break;
+            switch (json[pos + 1]) {
+                case '"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    pos += 2;
+                    break;
+                case 'u':
+                    for (size_t i = 2; i < 6; i++) {
+                        if (pos + i >= size || !IsHexDigit(json[pos + i])) {
+                            fail(pos, "Invalid \\u escape in string (expected 4 hex digits)");
+                            return false;
+                        }
+                    }
+                    pos += 6;
+                    break;
+                default:
+                    fail(pos, "Invalid escape sequence in string");
+                    return false;
+            }
+        }
+        fail(open, "Unterminated string");
+        return false;
+    }
+
+    bool parseNumber() {
+        size_t start = pos;
+        if (json[pos] == '-') pos++;
+        if (pos < size && json[pos] == '0') {
+            pos++;
+        } else if (pos < size && IsDigit(json[pos])) {
+            while (pos < size && IsDigit(json[pos])) pos++;
+        } else {
+            fail(start, "Invalid number");
+            return false;
+        }
+        if (pos < size && json[pos] == '.') {
+            pos++;
+            if (pos >= size || !IsDigit(json[pos])) {
+                fail(start, "Invalid number (digits expected after '.')");
+                return false;
+            }
+            while (pos < size && IsDigit(json[pos])) pos++;
+        }
+        if (pos < size && (json[pos] == 'e' || json[pos] == 'E')) {
+            pos++;
+            if (pos < size && (json[pos] == '+' || json[pos] == '-')) pos++;
+            if (pos >= size || !IsDigit(json[pos])) {
+                fail(start, "Invalid number (digits expected in exponent)");
+                return false;
+            }
+            while (pos < size && IsDigit(json[pos])) pos++;
+        }
+        return true;
+    }
+
+    bool parseLiteral(std::string_view literal) {
+        if (json.substr(pos, literal.size()) != literal) {
+            fail(pos, "Invalid literal (expected true, false or null)");
+            return false;
+        }
+        pos += literal.size();
+        return true;
+    }
+
+    std::string_view json;
+    size_t size;
+    size_t pos = 0;
+    size_t sectionStart = 0;
+    std::string_view currentKey;
+    std::vector<char> stack;  // '{' o '[' por cada contenedor abierto
+    bool failed = false;
+    JsonValidationResult result;
+};
+}  // namespace
+
+JsonValidationResult ValidateJson(std::string_view json) {
+    return JsonValidator(json).run();
+}
+
+// ===== NUEVA FUNCIÓN: VALIDACIÓN SIMPLE DE INTEGRIDAD JSON AL INICIO =====
+
+bool PerformSimpleJsonIntegrityCheck(const fs::path& jsonPath, std::string_view content, AsyncLog& logFile) {
+    try {
+        logFile << "Performing SIMPLE JSON integrity check at startup..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+
+        // Verificar que el archivo existe
+        if (!fs::exists(jsonPath)) {
+            logFile.error() << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
+            return false;
+        }
+
+        // Verificar tamaño mínimo (sobre el buffer ya cargado, SIN releer el archivo)
+        auto fileSize = content.size();
+        if (fileSize < 10) {
+            logFile.error() << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
+            return false;
+        }
+
+        logFile << "JSON file size: " << fileSize << " bytes" << std::endl;
+
+        // VALIDACIÓN 1: Gramática JSON completa en una sola pasada (llaves, corchetes, comas, cadenas,
+        // escapes, números y literales), con la posición exacta del primer error
+        JsonValidationResult validation = ValidateJson(content);
+        if (!validation.valid) {
+            logFile.error() << "ERROR: Invalid JSON at line " << validation.errorLine << ", column "
+                            << validation.errorColumn << " (byte " << validation.errorOffset << "): " << validation.error
+                            << std::endl;
+            return false;
+        }
+
+        if (validation.trailingCommas > 0) {
+            size_t line = 0;
+            size_t column = 0;
+            LocateJsonOffset(content, validation.firstTrailingComma, line, column);
+            logFile.error() << "WARNING: Found " << validation.trailingCommas
+                            << " comma(s) before a closing brace or bracket (may cause issues), first at line " << line
+                            << ", column " << column << std::endl;
+        }
+
+        // VALIDACIÓN 2: Verificar que el objeto raíz contiene las claves básicas esperadas de OBody
+        const std::vector<std::string> expectedKeys = {
+            "npcFormID",       "npc",           "factionFemale", "factionMale",
+            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+        int foundKeys = 0;
+        for (const auto& key : expectedKeys) {
+            if (validation.sections.find(key) != nullptr) {
+                foundKeys++;
+            }
+        }
+
+        if (foundKeys < 6) {  // Al menos 6 de las 8 claves esperadas
+            logFile.error() << "ERROR: JSON appears to be corrupted or not a valid OBody config file" << std::endl;
+            logFile << " Expected at least 6 OBody keys, found only " << foundKeys << std::endl;
+            return false;
+        }
+
+        logFile << "SUCCESS: JSON passed SIMPLE integrity check!" << std::endl;
+        logFile << " Found " << foundKeys << " valid OBody keys" << std::endl;
+        logFile << " Braces balanced: YES" << std::endl;
+        logFile << " Brackets balanced: YES" << std::endl;
+        logFile << " JSON grammar: VALID" << std::endl;
+        logFile << std::endl;
+
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in PerformSimpleJsonIntegrityCheck: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in PerformSimpleJsonIntegrityCheck: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== UTILIDADES DE SISTEMA DE ARCHIVOS =====
+
+void CreateDirectoryIfNotExists(const fs::path& path) {
+    try {
+        if (!fs::exists(path)) {
+            fs::create_directories(path);
+        }
+    } catch (...) {
+        // Silent fail
+    }
+}
+
+// ===== FUNCIONES UTILITARIAS MEJORADAS =====
+
+// ===== TOKENIZADOR SIN COPIAS =====
+// TrimView y NextToken trabajan sobre vistas del texto original: el parseo de INI y reglas no reserva
+// memoria, y sólo se construye un std::string cuando un valor se guarda. Trim y Split son las
+// variantes que materializan el resultado.
+
+std::string_view TrimView(std::string_view str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return {};
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+// Extrae el siguiente token recortado y no vacío de remaining (los tokens vacíos se omiten, igual
+// que hacía el Split basado en getline). Devuelve false cuando no quedan tokens.
+bool NextToken(std::string_view& remaining, char delimiter, std::string_view& token) {
+    while (!remaining.empty()) {
+        size_t delimiterPos = remaining.find(delimiter);
+        token = TrimView(remaining.substr(0, delimiterPos));
+        remaining = delimiterPos == std::string_view::npos ? std::string_view() : remaining.substr(delimiterPos + 1);
+        if (!token.empty()) return true;
+    }
+    return false;
+}
+
+std::string Trim(std::string_view str) {
+    return std::string(TrimView(str));
+}
+
+std::vector<std::string> Split(std::string_view str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::string_view token;
+    while (NextToken(str, delimiter, token)) {
+        tokens.emplace_back(token);
+    }
+    return tokens;
+}
+
+std::string EscapeJson(std::string_view str) {
+    std::string result;
+    result.reserve(str.length() * 1.3);
+
+    for (char c : str) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\b':
+                result += "\\b";
+                break;
+            case '\f':
+                result += "\\f";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                // Los bytes UTF-8 (>= 0x80) se copian tal cual: escaparlos byte a byte rompería los caracteres
+                if (byte >= 0x20) {
+                    result += c;
+                } else {
+                    char buf[7];
+                    snprintf(buf, sizeof(buf), "\\u%04x", byte);
+                    result += buf;
+                }
+        }
+    }
+    return result;
+}
+
+std::string UnescapeJson(std::string_view str) {
+    std::string result;
+    result.reserve(str.size());
+
+    auto appendUtf8 = [&result](uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            result += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            result += static_cast<char>(0xC0 | (codePoint >> 6));
+            result += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            result += static_cast<char>(0xE0 | (codePoint >> 12));
+            result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (codePoint >> 18));
+            result += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    };
+
+    auto parseHex4 = [&str](size_t pos, uint32_t& value) {
+        if (pos + 4 > str.size()) return false;
+        value = 0;
+        for (size_t i = pos; i < pos + 4; i++) {
+            char c = str[i];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < str.size(); i++) {
+        char c = str[i];
+        if (c != '\\' || i + 1 >= str.size()) {
+            result += c;
+            continue;
+        }
+
+        char next = str[i + 1];
+        switch (next) {
+            case '"':
+            case '\\':
+            case '/':
+                result += next;
+                i++;
+                break;
+            case 'b':
+                result += '\b';
+                i++;
+                break;
+            case 'f':
+                result += '\f';
+                i++;
+                break;
+            case 'n':
+                result += '\n';
+                i++;
+                break;
+            case 'r':
+                result += '\r';
+                i++;
+                break;
+            case 't':
+                result += '\t';
+                i++;
+                break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!parseHex4(i + 2, codePoint)) {
+                    result += c;  // Escape inválido: se conserva literal
+                    break;
+                }
+                size_t consumed = 6;
+                // Par sustituto UTF-16: \uD83D\uDE00 -> un único carácter de 4 bytes en UTF-8
+                uint32_t low = 0;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 12 <= str.size() && str[i + 6] == '\\' &&
+                    str[i + 7] == 'u' && parseHex4(i + 8, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    consumed = 12;
+                }
+                appendUtf8(codePoint);
+                i += consumed - 1;
+                break;
+            }
+            default:
+                result += c;  // Escape desconocido: se conserva literal
+                break;
+        }
+    }
+    return result;
+}
+
+// ===== TABLA DE NOMBRES INTERNADOS =====
+
+std::string_view NameTable::store(std::string_view name) {
+    if (name.size() > kBlockSize / 4) {
+        // Los nombres muy largos van en un bloque propio para no desperdiciar el bloque en curso
+        blocks.push_back(std::make_unique<char[]>(name.size()));
+        std::memcpy(blocks.back().get(), name.data(), name.size());
+        return std::string_view(blocks.back().get(), name.size());
+    }
+
+    if (currentBlock == nullptr || blockUsed + name.size() > kBlockSize) {
+        blocks.push_back(std::make_unique<char[]>(kBlockSize));
+        currentBlock = blocks.back().get();
+        blockUsed = 0;
+    }
+
+    char* destination = currentBlock + blockUsed;
+    if (!name.empty()) {
+        std::memcpy(destination, name.data(), name.size());
+    }
+    blockUsed += name.size();
+    return std::string_view(destination, name.size());
+}
+
+NameId NameTable::find(std::string_view name) const {
+    auto it = lookup.find(name);
+    return it == lookup.end() ? kInvalidName : it->second;
+}
+
+NameId NameTable::intern(std::string_view name) {
+    auto it = lookup.find(name);
+    if (it != lookup.end()) {
+        return it->second;
+    }
+
+    // "!X" y "X" quedan enlazados para que las eliminaciones ignoren el prefijo sin comparar texto
+    NameId strippedId = kInvalidName;
+    if (!name.empty() && name[0] == '!') {
+        strippedId = intern(name.substr(1));
+    }
+
+    NameId id = static_cast<NameId>(entries.size());
+    Entry& entry = entries.emplace_back();
+    entry.text = store(name);
+    entry.stripped = strippedId == kInvalidName ? id : strippedId;
+    if (strippedId != kInvalidName) {
+        entries[strippedId].bang = id;
+    }
+    lookup.emplace(entries[id].text, id);
+    return id;
+}
+
+const std::string& NameTable::escaped(NameId id) const {
+    if (escapedCache.size() < entries.size()) {
+        escapedCache.resize(entries.size());
+        escapedReady.resize(entries.size(), false);
+    }
+    if (!escapedReady[id]) {
+        escapedCache[id] = EscapeJson(entries[id].text);
+        escapedReady[id] = true;
+    }
+    return escapedCache[id];
+}
+
+ParsedRule ParseRuleLine(std::string_view key, std::string_view value) {
+    ParsedRule rule;
+    rule.key = key;
+
+    // Sólo importan los tres primeros campos no vacíos: plugin | presets | modo
+    std::string_view parts[3];
+    size_t partCount = 0;
+    while (partCount < 3 && NextToken(value, '|', parts[partCount])) {
+        partCount++;
+    }
+
+    if (partCount >= 2) {
+        rule.plugin = parts[0];
+        std::string_view presetList = parts[1];
+        std::string_view preset;
+        while (NextToken(presetList, ',', preset)) {
+            rule.presets.push_back(preset);
+        }
+
+        if (partCount >= 3) {
+            rule.extra = parts[2];
+            if (rule.extra.empty()) {
+                rule.applyCount = -1;
+            } else if (rule.extra == "x" || rule.extra == "X") {
+                rule.applyCount = -1;
+            } else if (rule.extra == "x-" || rule.extra == "X-") {
+                rule.applyCount = -4;
+            } else if (rule.extra == "x*" || rule.extra == "X*") {
+                rule.applyCount = -5;
+            } else if (rule.extra == "-") {
+                rule.applyCount = -2;
+            } else if (rule.extra == "*") {
+                rule.applyCount = -3;
+            } else {
+                // Como std::stoi: admite '+' inicial e ignora lo que siga al número
+                std::string_view digits = rule.extra;
+                if (digits.size() > 1 && digits[0] == '+' && digits[1] != '-') digits.remove_prefix(1);
+                int parsed = 0;
+                auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), parsed);
+                rule.applyCount = (error == std::errc() && (parsed == 0 || parsed == 1)) ? parsed : 0;
+            }
+        } else {
+            rule.applyCount = -1;
+        }
+    }
+
+    return rule;
+}
+
+// ===== SISTEMA DE BACKUP LITERAL PERFECTO =====
+
+int ReadBackupConfigFromIni(const fs::path& iniPath, AsyncLog& logFile) {
+    try {
+        if (!fs::exists(iniPath)) {
+            logFile << "Creating backup config INI at: " << iniPath.string() << std::endl;
+            std::ofstream createIni(iniPath, std::ios::out | std::ios::trunc);
+            if (createIni.is_open()) {
+                createIni << "[Original backup]" << std::endl;
+                createIni << "Backup = 1" << std::endl;
+                createIni << std::endl;
+                createIni << "[Run cache]" << std::endl;
+                createIni << "ForceRun = 0" << std::endl;
+                createIni << std::endl;
+                createIni << "[Execution]" << std::endl;
+                createIni << "Async = 1" << std::endl;
+                createIni << std::endl;
+                createIni << "[Formatting]" << std::endl;
+                createIni << "Repair = 1" << std::endl;
+                createIni << std::endl;
+                createIni << "[Backup store]" << std::endl;
+                createIni << "KeepVersions = 10" << std::endl;
+                createIni << "Compress = 1" << std::endl;
+                createIni << std::endl;
+                createIni << "[Logging]" << std::endl;
+                createIni << "Level = detail" << std::endl;
+                createIni << std::endl;
+                createIni << "[Run report]" << std::endl;
+                createIni << "TrackMemory = 0" << std::endl;
+                createIni.close();
+                logFile << "SUCCESS: Backup config INI created with default value (Backup = 1)" << std::endl;
+                return 1;
+            } else {
+                logFile.error() << "ERROR: Could not create backup config INI file!" << std::endl;
+                return 0;
+            }
+        }
+
+        std::ifstream iniFile(iniPath);
+        if (!iniFile.is_open()) {
+            logFile.error() << "ERROR: Could not open backup config INI file for reading!" << std::endl;
+            return 0;
+        }
+
+        std::string line;
+        bool inBackupSection = false;
+        int backupValue = 1;
+
+        while (std::getline(iniFile, line)) {
+            std::string_view trimmedLine = TrimView(line);
+
+            if (trimmedLine == "[Original backup]") {
+                inBackupSection = true;
+                continue;
+            }
+
+            if (trimmedLine.length() > 0 && trimmedLine[0] == '[' && trimmedLine != "[Original backup]") {
+                inBackupSection = false;
+                continue;
+            }
+
+            if (inBackupSection) {
+                size_t equalPos = trimmedLine.find('=');
+                if (equalPos != std::string_view::npos) {
+                    std::string_view key = TrimView(trimmedLine.substr(0, equalPos));
+                    std::string value(TrimView(trimmedLine.substr(equalPos + 1)));
+
+                    if (key == "Backup") {
+                        if (value == "true" || value == "True" || value == "TRUE") {
+                            backupValue = 2;  // Valor especial: siempre hacer backup
+                            logFile << "Read backup config: Backup = true (always backup mode)" << std::endl;
+                        } else {
+                            try {
+                                backupValue = std::stoi(value);
+                                logFile << "Read backup config: Backup = " << backupValue << std::endl;
+                            } catch (...) {
+                                logFile.error() << "Warning: Invalid backup value '" << value << "', using default (1)"
+                                                << std::endl;
+                                backupValue = 1;
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        iniFile.close();
+        return backupValue;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in ReadBackupConfigFromIni: " << e.what() << std::endl;
+        return 0;
+    } catch (...) {
+        logFile.error() << "ERROR in ReadBackupConfigFromIni: Unknown exception" << std::endl;
+        return 0;
+    }
+}
+
+void UpdateBackupConfigInIni(const fs::path& iniPath, AsyncLog& logFile, int originalValue) {
+    try {
+        if (!fs::exists(iniPath)) {
+            logFile.error() << "ERROR: Backup config INI file does not exist for update!" << std::endl;
+            return;
+        }
+
+        if (originalValue == 2) {
+            logFile << "INFO: Backup = true detected, INI will not be updated (always backup mode)" << std::endl;
+            return;
+        }
+
+        std::ifstream iniFile(iniPath);
+        if (!iniFile.is_open()) {
+            logFile.error() << "ERROR: Could not open backup config INI file for reading during update!" << std::endl;
+            return;
+        }
+
+        std::vector<std::string> lines;
+        std::string line;
+        bool inBackupSection = false;
+        bool backupValueUpdated = false;
+        lines.reserve(100);
+
+        while (std::getline(iniFile, line)) {
+            std::string_view trimmedLine = TrimView(line);
+
+            if (trimmedLine == "[Original backup]") {
+                inBackupSection = true;
+                lines.push_back(line);
+                continue;
+            }
+
+            if (trimmedLine.length() > 0 && trimmedLine[0] == '[' && trimmedLine != "[Original backup]") {
+                inBackupSection = false;
+                lines.push_back(line);
+                continue;
+            }
+
+            if (inBackupSection) {
+                size_t equalPos = trimmedLine.find('=');
+                if (equalPos != std::string_view::npos) {
+                    std::string_view key = TrimView(trimmedLine.substr(0, equalPos));
+                    if (key == "Backup") {
+                        lines.push_back("Backup = 0");
+                        backupValueUpdated = true;
+                        continue;
+                    }
+                }
+            }
+
+            lines.push_back(line);
+        }
+
+        iniFile.close();
+
+        if (!backupValueUpdated) {
+            logFile.error() << "Warning: Backup value not found in INI during update!" << std::endl;
+            return;
+        }
+
+        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            logFile.error() << "ERROR: Could not open backup config INI file for writing during update!" << std::endl;
+            return;
+        }
+
+        for (const auto& outputLine : lines) {
+            outFile << outputLine << std::endl;
+        }
+
+        outFile.close();
+        if (outFile.fail()) {
+            logFile.error() << "ERROR: Failed to write backup config INI file!" << std::endl;
+        } else {
+            logFile << "SUCCESS: Backup config updated (Backup = 0)" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in UpdateBackupConfigInIni: " << e.what() << std::endl;
+    } catch (...) {
+        logFile.error() << "ERROR in UpdateBackupConfigInIni: Unknown exception" << std::endl;
+    }
+}
+
+// ===== LECTURA/ESCRITURA GENÉRICA DE AJUSTES INI =====
+
+std::string ReadIniValue(const fs::path& iniPath, const std::string& section, const std::string& key,
+                         const std::string& defaultValue) {
+    try {
+        std::ifstream iniFile(iniPath);
+        if (!iniFile.is_open()) return defaultValue;
+
+        const std::string sectionHeader = "[" + section + "]";
+        std::string line;
+        bool inSection = false;
+
+        while (std::getline(iniFile, line)) {
+            std::string_view trimmedLine = TrimView(line);
+            if (!trimmedLine.empty() && trimmedLine[0] == '[') {
+                inSection = (trimmedLine == sectionHeader);
+                continue;
+            }
+
+            if (inSection) {
+                size_t equalPos = trimmedLine.find('=');
+                if (equalPos != std::string_view::npos && TrimView(trimmedLine.substr(0, equalPos)) == key) {
+                    return Trim(trimmedLine.substr(equalPos + 1));
+                }
+            }
+        }
+        return defaultValue;
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+bool WriteIniValue(const fs::path& iniPath, const std::string& section, const std::string& key,
+                   const std::string& value) {
+    try {
+        std::vector<std::string> lines;
+        {
+            std::ifstream iniFile(iniPath);
+            std::string line;
+            while (iniFile.is_open() && std::getline(iniFile, line)) {
+                lines.push_back(line);
+            }
+        }
+
+        const std::string sectionHeader = "[" + section + "]";
+        const std::string newLine = key + " = " + value;
+        bool inSection = false;
+        bool written = false;
+        size_t sectionEnd = std::string::npos;  // Posición de inserción si la clave no existe
+
+        for (size_t i = 0; i < lines.size() && !written; i++) {
+            std::string_view trimmedLine = TrimView(lines[i]);
+            if (!trimmedLine.empty() && trimmedLine[0] == '[') {
+                inSection = (trimmedLine == sectionHeader);
+                if (inSection) sectionEnd = i + 1;
+                continue;
+            }
+
+            if (inSection) {
+                size_t equalPos = trimmedLine.find('=');
+                if (equalPos != std::string_view::npos && TrimView(trimmedLine.substr(0, equalPos)) == key) {
+                    lines[i] = newLine;
+                    written = true;
+                } else if (!trimmedLine.empty()) {
+                    sectionEnd = i + 1;
+                }
+            }
+        }
+
+        if (!written) {
+            if (sectionEnd != std::string::npos) {
+                lines.insert(lines.begin() + sectionEnd, newLine);
+            } else {
+                if (!lines.empty() && !TrimView(lines.back()).empty()) lines.push_back("");
+                lines.push_back(sectionHeader);
+                lines.push_back(newLine);
+            }
+        }
+
+        std::string output;
+        for (const auto& outputLine : lines) {
+            output += outputLine;
+            output += '\n';
+        }
+
+        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) return false;
+        outFile << output;
+        outFile.close();
+        return !outFile.fail();
+    } catch (...) {
+        return false;
+    }
+}
+
+// Modo de tres estados compartido por los ajustes "una vez / siempre": 0 = desactivado,
+// 1 = una sola vez (se vuelve a 0 tras usarse), 2 = "true" (siempre)
+int ParseOnceOrAlwaysValue(const std::string& value, int defaultValue) {
+    if (value == "true" || value == "True" || value == "TRUE") return 2;
+    if (value == "false" || value == "False" || value == "FALSE") return 0;
+    try {
+        int parsed = std::stoi(value);
+        return parsed > 0 ? 1 : 0;
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+// ===== BACKUP LITERAL BYTE-POR-BYTE (CORREGIDO) =====
+
+bool PerformLiteralJsonBackup(const fs::path& originalJsonPath, const fs::path& backupJsonPath,
+                              std::string_view content, const BackupStore& store, AsyncLog& logFile) {
+    try {
+        if (!fs::exists(originalJsonPath)) {
+            logFile.error() << "ERROR: Original JSON file does not exist at: " << originalJsonPath.string()
+                            << std::endl;
+            return false;
+        }
+
+        CreateDirectoryIfNotExists(backupJsonPath.parent_path());
+
+        // COPIA LITERAL PERFECTA - SIN PROCESAMIENTO
+        std::error_code ec;
+        fs::copy_file(originalJsonPath, backupJsonPath, fs::copy_options::overwrite_existing, ec);
+
+        if (ec) {
+            logFile.error() << "ERROR: Failed to copy JSON file directly: " << ec.message() << std::endl;
+            return false;
+        }
+
+        // Verificación de integridad byte-por-byte
+        try {
+            auto originalSize = fs::file_size(originalJsonPath);
+            auto backupSize = fs::file_size(backupJsonPath);
+
+            if (originalSize == backupSize && originalSize > 0) {
+                logFile << "SUCCESS: LITERAL JSON backup completed to: " << backupJsonPath.string() << std::endl;
+                logFile << "Backup file size: " << backupSize << " bytes (verified identical to original)" << std::endl;
+
+                // Nueva versión en el almacén (si el contenido ya estaba, no ocupa más espacio)
+                if (!StoreBackupSnapshot(store, "backup", content, logFile)) {
+                    logFile.error() << "WARNING: Backup could not be added to the backup store (literal copy is intact)"
+                                    << std::endl;
+                }
+                return true;
+            } else {
+                logFile.error() << "ERROR: Backup file size mismatch! Original: " << originalSize << ", Backup: "
+                                << backupSize << std::endl;
+                return false;
+            }
+
+        } catch (...) {
+            logFile << "SUCCESS: LITERAL JSON backup completed (size verification failed but backup exists)"
+                    << std::endl;
+            return true;
+        }
+
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in PerformLiteralJsonBackup: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in PerformLiteralJsonBackup: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== VERIFICACIÓN TRIPLE DE INTEGRIDAD =====
+
+bool PerformTripleValidation(std::string_view content, AsyncLog& logFile, JsonSectionIndex* sectionIndex) {
+    try {
+        // Valida el buffer en memoria: ningún llamador necesita releer el archivo desde el disco
+        auto fileSize = content.size();
+        if (fileSize < 10) {
+            logFile.error() << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
+            return false;
+        }
+
+        // VALIDACIÓN 1: Gramática JSON completa en una sola pasada
+        JsonValidationResult validation = ValidateJson(content);
+        if (!validation.valid) {
+            logFile.error() << "ERROR: Invalid JSON at line " << validation.errorLine << ", column "
+                            << validation.errorColumn << " (byte " << validation.errorOffset << "): " << validation.error
+                            << std::endl;
+            return false;
+        }
+
+        // VALIDACIÓN 2: Claves OBody esperadas en el objeto raíz
+        const std::vector<std::string> expectedKeys = {
+            "npcFormID",       "npc",           "factionFemale", "factionMale",
+            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+        int foundKeys = 0;
+        for (const auto& key : expectedKeys) {
+            if (validation.sections.find(key) != nullptr) {
+                foundKeys++;
+            }
+        }
+
+        if (foundKeys < 6) {
+            logFile.error() << "ERROR: JSON appears corrupted (missing expected keys, found only " << foundKeys
+                            << " out of " << expectedKeys.size() << ")" << std::endl;
+            return false;
+        }
+
+        if (sectionIndex != nullptr) {
+            *sectionIndex = std::move(validation.sections);
+        }
+
+        logFile << "SUCCESS: JSON file passed TRIPLE validation (" << fileSize << " bytes, " << foundKeys
+                << " valid keys found)" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in PerformTripleValidation: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in PerformTripleValidation: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== ALMACÉN DE BACKUPS DIRECCIONADO POR CONTENIDO =====
+
+namespace {
+const char* const kBackupStoreFormatVersion = "1";
+
+std::string CurrentTimestamp() {
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm = SafeLocalTime(now);
+
+    char timestamp[32];
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+    return timestamp;
+}
+
+std::string FormatHash(uint64_t hash) {
+    std::ostringstream text;
+    text << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return text.str();
+}
+
+std::string FormatStoreEntry(const BackupStoreEntry& entry) {
+    std::ostringstream line;
+    line << entry.sequence << "|" << entry.kind << "|" << entry.timestamp << "|" << FormatHash(entry.hash) << "|"
+         << entry.size << "|" << (entry.compressed ? "lz" : "json");
+    return line.str();
+}
+
+bool ParseStoreEntry(std::string_view value, BackupStoreEntry& entry) {
+    std::string_view fields[6];
+    for (size_t i = 0; i < 6; i++) {
+        size_t separator = (i < 5) ? value.find('|') : std::string_view::npos;
+        if (i < 5 && separator == std::string_view::npos) return false;
+        fields[i] = TrimView(value.substr(0, separator));
+        value = (i < 5) ? value.substr(separator + 1) : std::string_view();
+    }
+
+    auto parseField = [](std::string_view field, auto& result, int base) {
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), result, base);
+        return error == std::errc() && end == field.data() + field.size();
+    };
+
+    if (fields[1].empty() || (fields[5] != "lz" && fields[5] != "json")) return false;
+    entry.kind = std::string(fields[1]);
+    entry.timestamp = std::string(fields[2]);
+    entry.compressed = (fields[5] == "lz");
+    return parseField(fields[0], entry.sequence, 10) && parseField(fields[3], entry.hash, 16) &&
+           parseField(fields[4], entry.size, 10);
+}
+
+// ----- Compresión LZ77 de los blobs -----
+// Formato propio, del estilo de un bloque LZ4: "PDLZ", el tamaño original (8 bytes, little-endian) y
+// secuencias de [token][literales][desplazamiento de 2 bytes][extensión de longitud]. El token lleva la
+// longitud de los literales en el nibble alto y la de la coincidencia menos 4 en el bajo; 15 indica que
+// siguen bytes de extensión (255 = sigue otro). La última secuencia sólo tiene literales.
+
+constexpr char kBlobMagic[4] = {'P', 'D', 'L', 'Z'};
+constexpr size_t kBlobHeaderSize = 12;
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxMatchOffset = 65535;
+constexpr int kMatchHashBits = 15;
+
+uint32_t Load32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void PutExtendedLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+bool GetExtendedLength(std::string_view blob, size_t& pos, size_t& length) {
+    unsigned char byte = 255;
+    while (byte == 255) {
+        if (pos >= blob.size()) return false;
+        byte = static_cast<unsigned char>(blob[pos++]);
+        length += byte;
+    }
+    return true;
+}
+
+void PutSequence(std::string& out, std::string_view literals, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength == 0 ? 0 : matchLength - kMinMatch;
+    out.push_back(static_cast<char>((std::min<size_t>(literals.size(), 15) << 4) | std::min<size_t>(matchCode, 15)));
+    if (literals.size() >= 15) PutExtendedLength(out, literals.size() - 15);
+    out.append(literals);
+    if (matchLength == 0) return;
+
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (matchCode >= 15) PutExtendedLength(out, matchCode - 15);
+}
+}  // namespace
+
+std::string CompressBlob(std::string_view data) {
+    std::string out;
+    out.reserve(kBlobHeaderSize + data.size() / 3);
+    out.append(kBlobMagic, sizeof(kBlobMagic));
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<char>((static_cast<uint64_t>(data.size()) >> (i * 8)) & 0xFF));
+    }
+
+    // Una sola posición candidata por hash de 4 bytes: compresión voraz y de coste lineal
+    std::vector<size_t> candidates(size_t{1} << kMatchHashBits, SIZE_MAX);
+    const size_t size = data.size();
+    size_t anchor = 0;
+    size_t pos = 0;
+
+    while (pos + kMinMatch <= size) {
+        uint32_t sequence = Load32(data.data() + pos);
+        size_t slot = (sequence * 2654435761U) >> (32 - kMatchHashBits);
+        size_t candidate = candidates[slot];
+        candidates[slot] = pos;
+
+        if (candidate == SIZE_MAX || pos - candidate > kMaxMatchOffset || Load32(data.data() + candidate) != sequence) {
+            pos++;
+            continue;
+        }
+
+        size_t length = kMinMatch;
+        while (pos + length < size && data[candidate + length] == data[pos + length]) length++;
+
+        PutSequence(out, data.substr(anchor, pos - anchor), pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    PutSequence(out, data.substr(anchor), 0, 0);
+    return out;
+}
+
+bool DecompressBlob(std::string_view blob, std::string& data) {
+    data.clear();
+    if (blob.size() < kBlobHeaderSize || blob.substr(0, sizeof(kBlobMagic)) != std::string_view(kBlobMagic, 4)) {
+        return false;
+    }
+
+    uint64_t size = 0;
+    for (int i = 0; i < 8; i++) {
+        size |= static_cast<uint64_t>(static_cast<unsigned char>(blob[4 + i])) << (i * 8);
+    }
+    // Cada byte comprimido produce como mucho 255 bytes: un tamaño mayor sólo puede venir de un blob dañado
+    if (size / 255 > blob.size()) return false;
+
+    data.resize(static_cast<size_t>(size));
+    size_t in = kBlobHeaderSize;
+    size_t out = 0;
+    while (true) {
+        if (in >= blob.size()) return false;
+        unsigned char token = static_cast<unsigned char>(blob[in++]);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !GetExtendedLength(blob, in, literalLength)) return false;
+        if (literalLength > blob.size() - in || literalLength > data.size() - out) return false;
+        std::memcpy(data.data() + out, blob.data() + in, literalLength);
+        in += literalLength;
+        out += literalLength;
+        if (in == blob.size()) break;
+
+        if (blob.size() - in < 2) return false;
+        size_t offset = static_cast<unsigned char>(blob[in]) | (static_cast<size_t>(static_cast<unsigned char>(blob[in + 1])) << 8);
+        in += 2;
+        size_t matchLength = (token & 0x0F);
+        if (matchLength == 15 && !GetExtendedLength(blob, in, matchLength)) return false;
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > out || matchLength > data.size() - out) return false;
+
+        // La coincidencia puede solaparse con lo que está escribiendo: se copia byte a byte
+        for (size_t i = 0; i < matchLength; i++, out++) {
+            data[out] = data[out - offset];
+        }
+    }
+
+    if (out != data.size()) {
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+BackupStore ReadBackupStoreSettings(const fs::path& iniPath, const fs::path& root) {
+    BackupStore store;
+    store.root = root;
+
+    std::string keepValue = ReadIniValue(iniPath, "Backup store", "KeepVersions", "10");
+    size_t keepVersions = 0;
+    auto [end, error] = std::from_chars(keepValue.data(), keepValue.data() + keepValue.size(), keepVersions);
+    if (error == std::errc() && end == keepValue.data() + keepValue.size()) {
+        store.keepVersions = std::max<size_t>(keepVersions, 1);
+    }
+
+    store.compress = ParseOnceOrAlwaysValue(ReadIniValue(iniPath, "Backup store", "Compress", "1"), 1) != 0;
+    return store;
+}
+
+fs::path BackupBlobPath(const BackupStore& store, const BackupStoreEntry& entry) {
+    return store.root / "objects" / (FormatHash(entry.hash) + (entry.compressed ? ".lz" : ".json"));
+}
+
+bool LoadBackupStoreManifest(const BackupStore& store, BackupStoreManifest& manifest) {
+    manifest = BackupStoreManifest();
+    try {
+        std::ifstream manifestFile(store.root / "manifest.ini");
+        if (!manifestFile.is_open()) return false;
+
+        bool versionMatches = false;
+        std::string line;
+        while (std::getline(manifestFile, line)) {
+            size_t equalPos = line.find('=');
+            if (equalPos == std::string::npos) continue;
+            std::string_view key = TrimView(std::string_view(line).substr(0, equalPos));
+            std::string_view value = TrimView(std::string_view(line).substr(equalPos + 1));
+
+            if (key == "Version") {
+                versionMatches = (value == kBackupStoreFormatVersion);
+            } else if (key == "Entry") {
+                BackupStoreEntry entry;
+                if (!ParseStoreEntry(value, entry)) continue;  // Una línea dañada no invalida el resto
+                manifest.nextSequence = std::max(manifest.nextSequence, entry.sequence + 1);
+                manifest.entries.push_back(std::move(entry));
+            }
+        }
+
+        if (!versionMatches) {
+            manifest = BackupStoreManifest();
+            return false;
+        }
+        std::sort(manifest.entries.begin(), manifest.entries.end(),
+                  [](const BackupStoreEntry& a, const BackupStoreEntry& b) { return a.sequence < b.sequence; });
+        return true;
+    } catch (...) {
+        manifest = BackupStoreManifest();
+        return false;
+    }
+}
+
+bool SaveBackupStoreManifest(const BackupStore& store, const BackupStoreManifest& manifest, AsyncLog& logFile) {
+    try {
+        std::ostringstream content;
+        content << "; Generated by OBody NG Preset Distribution Assistant NG - do not edit." << '\n';
+        content << "; Entry = sequence|kind|timestamp|content hash|size|blob format (objects/<hash>.json or .lz)"
+                << '\n';
+        content << "[Backup store]" << '\n';
+        content << "Version = " << kBackupStoreFormatVersion << '\n';
+        for (const auto& entry : manifest.entries) {
+            content << "Entry = " << FormatStoreEntry(entry) << '\n';
+        }
+
+        // Se sustituye de una vez: un manifiesto a medio escribir dejaría versiones sin referenciar
+        fs::path manifestPath = store.root / "manifest.ini";
+        fs::path tempPath = manifestPath;
+        tempPath += ".tmp";
+        uint64_t checksum = 0;
+        std::error_code ec;
+        if (!WriteFileWithChecksum(tempPath, content.str(), checksum)) {
+            fs::remove(tempPath, ec);
+            logFile.error() << "WARNING: Could not write backup store manifest" << std::endl;
+            return false;
+        }
+        fs::rename(tempPath, manifestPath, ec);
+        if (ec) {
+            fs::remove(tempPath, ec);
+            logFile.error() << "WARNING: Could not replace backup store manifest" << std::endl;
+            return false;
+        }
+        return true;
+    } catch (...) {
+        logFile.error() << "WARNING: Could not write backup store manifest" << std::endl;
+        return false;
+    }
+}
+
+bool LoadBackupSnapshot(const BackupStore& store, const BackupStoreEntry& entry, std::string& content) {
+    std::string blob;
+    AsyncLog noLog;
+    if (!LoadJsonFile(BackupBlobPath(store, entry), blob, noLog)) return false;
+
+    if (entry.compressed) {
+        if (!DecompressBlob(blob, content)) return false;
+    } else {
+        content = std::move(blob);
+    }
+
+    // El nombre del blob es su hash: así se detecta un blob dañado en disco
+    return content.size() == entry.size && HashBytes(content) == entry.hash;
+}
+
+bool StoreBackupSnapshot(const BackupStore& store, std::string_view kind, std::string_view content,
+                         AsyncLog& logFile) {
+    try {
+        BackupStoreManifest manifest;
+        fs::path manifestPath = store.root / "manifest.ini";
+        if (!LoadBackupStoreManifest(store, manifest) && fs::exists(manifestPath)) {
+            // Un manifiesto ilegible (o de otra versión del formato) no se sustituye por uno nuevo: sus
+            // versiones se perderían. Se aparta y los blobs se conservan para poder recuperarlos a mano.
+            fs::path badPath = manifestPath;
+            badPath += ".bad";
+            if (fs::exists(badPath)) {
+                badPath += "." + CurrentTimestamp();
+            }
+            std::error_code ec;
+            fs::rename(manifestPath, badPath, ec);
+            logFile.error() << "ERROR: Backup store manifest could not be read; "
+                            << (ec ? "it could not be moved aside either"
+                                   : "moved aside as " + badPath.filename().string())
+                            << ". No version was saved and no blob was removed from " << store.root.string()
+                            << std::endl;
+            return false;
+        }
+        CreateDirectoryIfNotExists(store.root / "objects");
+
+        BackupStoreEntry entry;
+        entry.kind = std::string(kind);
+        entry.timestamp = CurrentTimestamp();
+        entry.hash = HashBytes(content);
+        entry.size = content.size();
+
+        // Mismo contenido ya guardado (con cualquier tipo): se reutiliza su blob si sigue intacto
+        bool stored = false;
+        std::string existing;
+        for (const auto& previous : manifest.entries) {
+            if (previous.hash != entry.hash || previous.size != entry.size) continue;
+            if (LoadBackupSnapshot(store, previous, existing) && existing == content) {
+                entry.compressed = previous.compressed;
+                stored = true;
+                break;
+            }
+        }
+
+        if (!stored) {
+            std::string compressed;
+            if (store.compress) {
+                compressed = CompressBlob(content);
+                entry.compressed = compressed.size() < content.size();
+            }
+            std::string_view blob = entry.compressed ? std::string_view(compressed) : content;
+
+            fs::path blobPath = BackupBlobPath(store, entry);
+            fs::path tempPath = blobPath;
+            tempPath += ".tmp";
+            WrittenContent written;
+            if (ReplaceFileVerified(blobPath, tempPath, blob, written, logFile) != ReplaceFileResult::Replaced) {
+                logFile.error() << "ERROR: Could not write backup store blob: " << blobPath.filename().string()
+                                << std::endl;
+                return false;
+            }
+        }
+
+        // Una sola versión por contenido y tipo: repetirlo la convierte en la más reciente
+        std::erase_if(manifest.entries, [&](const BackupStoreEntry& previous) {
+            return previous.kind == entry.kind && previous.hash == entry.hash;
+        });
+        entry.sequence = manifest.nextSequence++;
+        manifest.entries.push_back(entry);
+
+        // Retención: las keepVersions versiones más recientes de cada tipo
+        std::vector<BackupStoreEntry> dropped;
+        size_t kept = 0;
+        for (size_t i = manifest.entries.size(); i-- > 0;) {
+            if (manifest.entries[i].kind == entry.kind && ++kept > store.keepVersions) {
+                dropped.push_back(std::move(manifest.entries[i]));
+                manifest.entries.erase(manifest.entries.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+
+        if (!SaveBackupStoreManifest(store, manifest, logFile)) {
+            return false;
+        }
+
+        // Sólo se borran los blobs de las versiones que la retención acaba de descartar, si ninguna otra
+        // versión los usa: un archivo que el manifiesto no lista nunca se borra
+        std::error_code ec;
+        for (const auto& version : dropped) {
+            fs::path blobPath = BackupBlobPath(store, version);
+            bool shared = std::any_of(manifest.entries.begin(), manifest.entries.end(), [&](const BackupStoreEntry& other) {
+                return BackupBlobPath(store, other) == blobPath;
+            });
+            if (!shared) {
+                fs::remove(blobPath, ec);
+            }
+        }
+
+        logFile << "Backup store: saved " << entry.kind << " version #" << entry.sequence << " ("
+                << content.size() << " bytes, " << (stored ? "already stored" : "new blob")
+                << (entry.compressed ? ", compressed" : "") << ") as "
+                << BackupBlobPath(store, entry).filename().string() << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in StoreBackupSnapshot: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in StoreBackupSnapshot: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== ANÁLISIS FORENSE AUTOMÁTICO =====
+// Los JSON corruptos o rechazados se guardan en el almacén de backups: las copias repetidas ocupan un
+// solo blob y la retención limita cuántas versiones distintas se conservan
+
+// Contenido rechazado por la validación en memoria: nunca llegó a escribirse junto al JSON
+bool SaveRejectedJsonToAnalysis(std::string_view content, const BackupStore& store, AsyncLog& logFile) {
+    if (!StoreBackupSnapshot(store, "rejected", content, logFile)) {
+        logFile.error() << "ERROR: Failed to save rejected JSON to the backup store" << std::endl;
+        return false;
+    }
+    logFile << "SUCCESS: Rejected JSON saved for analysis in: " << store.root.string() << std::endl;
+    return true;
+}
+
+bool MoveCorruptedJsonToAnalysis(const fs::path& corruptedJsonPath, const BackupStore& store,
+                                 AsyncLog& logFile) {
+    try {
+        if (!fs::exists(corruptedJsonPath)) {
+            logFile.error() << "WARNING: Corrupted JSON file does not exist for analysis" << std::endl;
+            return false;
+        }
+
+        std::string content;
+        if (!LoadJsonFile(corruptedJsonPath, content, logFile) ||
+            !StoreBackupSnapshot(store, "corrupted", content, logFile)) {
+            logFile.error() << "ERROR: Failed to save corrupted JSON to the backup store" << std::endl;
+            return false;
+        }
+
+        logFile << "SUCCESS: Corrupted JSON saved for analysis in: " << store.root.string() << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in MoveCorruptedJsonToAnalysis: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in MoveCorruptedJsonToAnalysis: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== RESTAURACIÓN DESDE BACKUP =====
+
+bool RestoreJsonFromBackup(const fs::path& backupJsonPath, const fs::path& originalJsonPath,
+                           const BackupStore& store, std::string& restoredContent, AsyncLog& logFile) {
+    try {
+        // Versiones de backup del almacén, de la más reciente a la más antigua: la primera válida gana
+        std::string backupContent;
+        std::string source;
+        BackupStoreManifest manifest;
+        LoadBackupStoreManifest(store, manifest);
+        for (auto it = manifest.entries.rbegin(); it != manifest.entries.rend() && source.empty(); ++it) {
+            if (it->kind != "backup") continue;
+            if (!LoadBackupSnapshot(store, *it, backupContent)) {
+                logFile.error() << "WARNING: Backup store version #" << it->sequence << " is missing or damaged"
+                                << std::endl;
+                continue;
+            }
+            if (!PerformTripleValidation(backupContent, logFile)) {
+                logFile.error() << "WARNING: Backup store version #" << it->sequence << " is also corrupted"
+                                << std::endl;
+                continue;
+            }
+            source = "backup store version #" + std::to_string(it->sequence) + " (" + it->timestamp + ")";
+        }
+
+        // Sin versiones en el almacén: la copia literal de siempre
+        if (source.empty()) {
+            if (!fs::exists(backupJsonPath)) {
+                logFile.error() << "ERROR: Backup JSON file does not exist: " << backupJsonPath.string() << std::endl;
+                return false;
+            }
+            if (!LoadJsonFile(backupJsonPath, backupContent, logFile)) {
+                logFile.error() << "ERROR: Could not read backup JSON file: " << backupJsonPath.string() << std::endl;
+                return false;
+            }
+            if (!PerformTripleValidation(backupContent, logFile)) {
+                logFile.error() << "ERROR: Backup JSON file is also corrupted, cannot restore!" << std::endl;
+                return false;
+            }
+            source = backupJsonPath.string();
+        }
+
+        logFile.error() << "WARNING: Original JSON appears corrupted, restoring from " << source << "..." << std::endl;
+
+        // Guardar el archivo corrupto para análisis forense
+        if (fs::exists(originalJsonPath)) {
+            MoveCorruptedJsonToAnalysis(originalJsonPath, store, logFile);
+        }
+
+        // El contenido ya está validado en memoria: se escribe con la misma sustitución verificada
+        fs::path tempPath = originalJsonPath;
+        tempPath.replace_extension(".restore.tmp");
+        WrittenContent written;
+        if (ReplaceFileVerified(originalJsonPath, tempPath, backupContent, written, logFile) !=
+            ReplaceFileResult::Replaced) {
+            logFile.error() << "ERROR: Failed to restore JSON from backup!" << std::endl;
+            return false;
+        }
+
+        restoredContent = std::move(backupContent);
+        logFile << "SUCCESS: JSON restored from backup successfully!" << std::endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in RestoreJsonFromBackup: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in RestoreJsonFromBackup: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== REFORMATEO LINEAL CON TABLA DE CORCHETES =====
+// El reformateo canónico trabaja sobre el índice del escáner estructural: con él se construye la tabla
+// de corchetes (cierre correspondiente de cada apertura y si el bloque está vacío), una pasada mide el
+// resultado exacto y otra lo escribe en un buffer ya reservado. Las cadenas se copian enteras de una
+// comilla a la otra. Los espacios de indentación se emiten de forma perezosa, así los espacios finales
+// de cada línea nunca llegan al buffer.
+
+namespace {
+struct BracketMatch {
+    size_t close = std::string_view::npos;
+    bool empty = false;
+};
+
+// Una entrada por cada '{' o '[' estructural, en orden de aparición
+std::vector<BracketMatch> BuildBracketTable(std::string_view content, const JsonStructuralIndex& structure) {
+    const std::vector<uint32_t>& positions = structure.positions;
+    std::vector<BracketMatch> brackets;
+    brackets.reserve(static_cast<size_t>(std::count_if(positions.begin(), positions.end(), [content](uint32_t pos) {
+        return content[pos] == '{' || content[pos] == '[';
+    })));
+    std::vector<size_t> openStack;
+
+    for (uint32_t pos : positions) {
+        char c = content[pos];
+        if (c == '{' || c == '[') {
+            // Vacío = el primer carácter que no es espacio en blanco es su propio cierre
+            char closeChar = (c == '{') ? '}' : ']';
+            size_t next = content.find_first_not_of(" \t\r\n", pos + 1);
+            BracketMatch& match = brackets.emplace_back();
+            match.empty = next != std::string_view::npos && content[next] == closeChar;
+            openStack.push_back(brackets.size() - 1);
+        } else if ((c == '}' || c == ']') && !openStack.empty()) {
+            brackets[openStack.back()].close = pos;
+            openStack.pop_back();
+        }
+    }
+    return brackets;
+}
+
+// Destino del reformateo: con kWrite = false sólo cuenta bytes (pasada de medida)
+template <bool kWrite>
+class CanonicalJsonOutput {
+public:
+    explicit CanonicalJsonOutput(char* destination = nullptr) : destination(destination) {}
+
+    void put(char c) {
+        if (c == ' ') {
+            pendingSpaces++;
+            endsWithNewline = false;
+            return;
+        }
+        if (c == '\n') {
+            pendingSpaces = 0;  // Espacios al final de línea: se descartan
+        } else {
+            flushSpaces();
+        }
+        emit(c);
+        endsWithNewline = (c == '\n');
+    }
+
+    // Una cadena completa, copiada tal cual
+    void append(std::string_view run) {
+        if (run.find('\n') != std::string_view::npos) {
+            for (char c : run) put(c);
+            return;
+        }
+        size_t body = run.find_last_not_of(' ');
+        if (body != std::string_view::npos) {
+            flushSpaces();
+            if constexpr (kWrite) {
+                std::memcpy(destination + written, run.data(), body + 1);
+            }
+            written += body + 1;
+        }
+        if (!run.empty()) {
+            pendingSpaces += run.size() - (body == std::string_view::npos ? 0 : body + 1);
+            endsWithNewline = false;
+        }
+    }
+
+    void spaces(int count) {
+        if (count > 0) {
+            pendingSpaces += static_cast<size_t>(count);
+            endsWithNewline = false;
+        }
+    }
+
+    // Bytes emitidos, incluido un salto de línea final que finalSize() descarta
+    size_t emittedSize() const { return written; }
+    size_t finalSize() const { return endsWithNewline ? written - 1 : written; }
+
+private:
+    void flushSpaces() {
+        if constexpr (kWrite) {
+            std::memset(destination + written, ' ', pendingSpaces);
+        }
+        written += pendingSpaces;
+        pendingSpaces = 0;
+    }
+
+    void emit(char c) {
+        if constexpr (kWrite) {
+            destination[written] = c;
+        }
+        written++;
+    }
+
+    char* destination;
+    size_t written = 0;
+    size_t pendingSpaces = 0;
+    bool endsWithNewline = false;
+};
+
+template <typename Output>
+void EmitCanonicalJson(std::string_view content, const JsonStructuralIndex& structure,
+                       const std::vector<BracketMatch>& brackets, Output& out) {
+    const std::vector<uint32_t>& positions = structure.positions;
+    int indentLevel = 0;
+    size_t nextBracket = 0;
+    size_t copied = 0;  // Primer byte aún no emitido
+
+    // Entre dos posiciones estructurales sólo hay espacios en blanco (se descartan) y escalares
+    auto emitGap = [&](size_t end) {
+        for (; copied < end; copied++) {
+            char c = content[copied];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                out.put(c);
+            }
+        }
+    };
+
+    // Tras cerrar un bloque se salta de línea salvo que lo siguiente sea ',', '}' o ']'
+    auto breakAfterBlock = [&](size_t pos) {
+        while (pos < content.size() && std::isspace(static_cast<unsigned char>(content[pos]))) {
+            pos++;
+        }
+        if (pos < content.size() && content[pos] != ',' && content[pos] != '}' && content[pos] != ']') {
+            out.put('\n');
+            out.spaces(indentLevel * 4);
+        }
+    };
+
+    for (size_t k = 0; k < positions.size(); k++) {
+        size_t pos = positions[k];
+        emitGap(pos);
+        char c = content[pos];
+        copied = pos + 1;
+
+        switch (c) {
+            case '"': {
+                // La posición siguiente es la comilla de cierre; una cadena sin cerrar llega al final
+                size_t end = (k + 1 < positions.size()) ? positions[++k] + 1 : content.size();
+                out.append(content.substr(pos, end - pos));
+                copied = end;
+                break;
+            }
+
+            case '{':
+            case '[': {
+                const BracketMatch& match = brackets[nextBracket++];
+                if (match.empty) {
+                    // Bloque vacío (aunque ocupe varias líneas): se escribe en línea y se salta hasta el cierre,
+                    // que es la posición estructural siguiente
+                    out.put(c);
+                    out.put(content[match.close]);
+                    k++;
+                    copied = match.close + 1;
+                    breakAfterBlock(copied);
+                } else {
+                    out.put(c);
+                    out.put('\n');
+                    indentLevel++;
+                    out.spaces(indentLevel * 4);
+                }
+                break;
+            }
+
+            case '}':
+            case ']':
+                out.put('\n');
+                indentLevel--;
+                out.spaces(indentLevel * 4);
+                out.put(c);
+                breakAfterBlock(copied);
+                break;
+
+            case ',':
+                out.put(c);
+                out.put('\n');
+                out.spaces(indentLevel * 4);
+                break;
+
+            case ':':
+                out.put(c);
+                out.put(' ');
+                break;
+
+            default:
+                out.put(c);
+                break;
+        }
+    }
+    emitGap(content.size());
+}
+
+// Recorre las líneas una sola vez: indentación que no es múltiplo de 4 espacios (o con tabuladores) y
+// contenedores vacíos repartidos en varias líneas
+bool NeedsIndentCorrection(std::string_view content, AsyncLog& logFile) {
+    auto forEachLine = [content](auto&& visit) {
+        size_t lineStart = 0;
+        size_t lineNumber = 1;
+        while (lineStart < content.size()) {
+            size_t lineEnd = content.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos) lineEnd = content.size();
+            if (!visit(content.substr(lineStart, lineEnd - lineStart), lineNumber)) return;
+            lineStart = lineEnd + 1;
+            lineNumber++;
+        }
+    };
+
+    bool needsCorrection = false;
+    forEachLine([&](std::string_view line, size_t) {
+        size_t indentEnd = line.find_first_not_of(" \t");
+        if (indentEnd == std::string_view::npos) return true;  // Línea vacía o sólo espacios
+        std::string_view indent = line.substr(0, indentEnd);
+        if (indent.find('\t') != std::string_view::npos || indent.size() % 4 != 0) {
+            needsCorrection = true;
+            return false;
+        }
+        return true;
+    });
+    if (needsCorrection) return true;
+
+    // Una línea que termina en '{' o '[' seguida (tras líneas en blanco) de una línea que sólo contiene
+    // su cierre, con o sin coma
+    char pendingClose = 0;
+    size_t openLine = 0;
+    forEachLine([&](std::string_view line, size_t lineNumber) {
+        std::string_view trimmed = TrimView(line);
+        if (trimmed.empty()) return true;
+
+        if (pendingClose != 0 && (trimmed.size() == 1 || (trimmed.size() == 2 && trimmed[1] == ',')) &&
+            trimmed[0] == pendingClose) {
+            needsCorrection = true;
+            logFile << "DETECTED: Multi-line empty container found at lines " << openLine << "-" << lineNumber
+                    << ", needs inline correction" << std::endl;
+            return false;
+        }
+
+        pendingClose = 0;
+        if (trimmed.back() == '{' || trimmed.back() == '[') {
+            pendingClose = (trimmed.back() == '{') ? '}' : ']';
+            openLine = lineNumber;
+        }
+        return true;
+    });
+    return needsCorrection;
+}
+}  // namespace
+
+std::string FormatJsonCanonical(std::string_view content) {
+    JsonStructuralIndex structure = ScanJsonStructure(content);
+    std::vector<BracketMatch> brackets = BuildBracketTable(content, structure);
+
+    CanonicalJsonOutput<false> measure;
+    EmitCanonicalJson(content, structure, brackets, measure);
+
+    std::string formatted(measure.emittedSize(), '\0');
+    CanonicalJsonOutput<true> output(formatted.data());
+    EmitCanonicalJson(content, structure, brackets, output);
+    formatted.resize(output.finalSize());
+    return formatted;
+}
+
+// ===== NUEVA FUNCIÓN MEJORADA: CORRECCIÓN COMPLETA DE INDENTACIÓN CON EMPTY INLINE Y MULTI-LINE EMPTY DETECTION =====
+
+bool CorrectJsonIndentation(const fs::path& jsonPath, const std::string& originalContent, const BackupStore& store,
+                            WrittenContent& written, AsyncLog& logFile) {
+    try {
+        logFile << "Checking and correcting JSON indentation hierarchy..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+
+        // El pipeline entrega el contenido actual del JSON (recién escrito o el original), sin releer el disco
+        if (!fs::exists(jsonPath)) {
+            logFile.error() << "ERROR: JSON file does not exist for indentation correction" << std::endl;
+            return false;
+        }
+
+        if (originalContent.empty()) {
+            logFile.error() << "ERROR: JSON file is empty for indentation correction" << std::endl;
+            return false;
+        }
+
+        if (!NeedsIndentCorrection(originalContent, logFile)) {
+            logFile << "SUCCESS: JSON indentation is already correct (perfect 4-space hierarchy with inline empty "
+                       "containers)"
+                    << std::endl;
+            logFile << std::endl;
+            return true;
+        }
+
+        logFile << "DETECTED: JSON indentation needs correction - reformatting entire file with perfect 4-space "
+                   "hierarchy and inline empty containers..."
+                << std::endl;
+
+        std::string finalContent = FormatJsonCanonical(originalContent);
+
+        // Verificar integridad del contenido corregido en memoria antes de escribir nada
+        if (!PerformTripleValidation(finalContent, logFile)) {
+            logFile.error() << "ERROR: Corrected JSON failed integrity check!" << std::endl;
+            SaveRejectedJsonToAnalysis(finalContent, store, logFile);
+            return false;
+        }
+
+        // Escribir el JSON corregido y reemplazar el archivo original
+        fs::path tempPath = jsonPath;
+        tempPath.replace_extension(".indent_corrected.tmp");
+
+        if (ReplaceFileVerified(jsonPath, tempPath, finalContent, written, logFile) == ReplaceFileResult::Replaced) {
+            logFile << "SUCCESS: JSON indentation corrected successfully!" << std::endl;
+            logFile << " Applied perfect 4-space hierarchy with inline empty containers (including multi-line empty "
+                       "detection)"
+                    << std::endl;
+            logFile << std::endl;
+            return true;
+        } else {
+            logFile.error() << "ERROR: Final corrected JSON failed integrity check!" << std::endl;
+            return false;
+        }
+
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in CorrectJsonIndentation: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in CorrectJsonIndentation: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== HASH CANÓNICO DE SECCIÓN =====
+// Resume el contenido de una sección (plugins en orden y sus presets en orden) sobre los NameId de la
+// ejecución, sin depender del formato ni del escapado del texto. El hash de origen se calcula sobre
+// lo que devolvió el parser (incluidos duplicados o plugins vacíos que la carga descarta), así que una
+// sección que la carga tuvo que normalizar también cuenta como cambiada.
+
+namespace {
+uint64_t HashNameId(uint64_t hash, uint32_t value) {
+    return HashBytes(std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)), hash);
+}
+
+template <typename Entries>
+uint64_t HashEntries(const Entries& entries) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (const auto& [plugin, presets] : entries) {
+        hash = HashNameId(hash, plugin);
+        hash = HashNameId(hash, static_cast<uint32_t>(presets.size()));
+        for (NameId preset : presets) {
+            hash = HashNameId(hash, preset);
+        }
+    }
+    return hash;
+}
+}  // namespace
+
+uint64_t HashSectionEntries(const std::vector<std::pair<NameId, std::vector<NameId>>>& entries) {
+    return HashEntries(entries);
+}
+
+uint64_t HashSectionEntries(const OrderedPluginData& data) {
+    return HashEntries(data);
+}
+
+void RefreshSectionHash(OrderedPluginData& data) {
+    if (data.dirty) {
+        data.contentHash = HashSectionEntries(data);
+        data.dirty = false;
+    }
+}
+
+bool SectionChanged(const OrderedPluginData& data) {
+    uint64_t current = data.dirty ? HashSectionEntries(data) : data.contentHash;
+    return current != data.sourceHash;
+}
+
+// ===== SERIALIZADOR DE SECCIONES DE TAMAÑO EXACTO =====
+// Formato de una sección (4 espacios por nivel, la clave está en el nivel 1):
+// {\n        "plugin": [\n            "preset",\n            "preset"\n        ],\n        ...\n    }
+// Una sección vacía se escribe como {}. El tamaño se calcula antes de escribir, así el texto se genera
+// en un único buffer sin realojar.
+
+namespace {
+constexpr std::string_view kSectionOpen = "{\n";
+constexpr std::string_view kSectionClose = "\n    }";
+constexpr std::string_view kPluginOpen = "        \"";   // Nivel 2: 8 espacios
+constexpr std::string_view kPluginClose = "\": [\n";
+constexpr std::string_view kPresetOpen = "            \"";  // Nivel 3: 12 espacios
+constexpr std::string_view kPresetClose = "\"";
+constexpr std::string_view kArrayClose = "\n        ]";
+constexpr std::string_view kSeparator = ",\n";
+constexpr std::string_view kEmptySection = "{}";
+
+char* WriteText(char* cursor, std::string_view text) {
+    std::memcpy(cursor, text.data(), text.size());
+    return cursor + text.size();
+}
+}  // namespace
+
+size_t MeasureSection(const OrderedPluginData& data, const NameTable& names) {
+    if (data.empty()) return kEmptySection.size();
+
+    size_t size = kSectionOpen.size() + kSectionClose.size();
+    size_t pluginCount = 0;
+    for (const auto& [plugin, presets] : data) {
+        size += kPluginOpen.size() + names.escaped(plugin).size() + kPluginClose.size() + kArrayClose.size();
+        for (NameId preset : presets) {
+            size += kPresetOpen.size() + names.escaped(preset).size() + kPresetClose.size();
+        }
+        if (!presets.empty()) size += (presets.size() - 1) * kSeparator.size();
+        pluginCount++;
+    }
+    if (pluginCount > 0) size += (pluginCount - 1) * kSeparator.size();
+    return size;
+}
+
+std::string SerializeSection(const OrderedPluginData& data, const NameTable& names) {
+    if (data.empty()) return std::string(kEmptySection);
+
+    std::string text(MeasureSection(data, names), '\0');
+    char* cursor = WriteText(text.data(), kSectionOpen);
+
+    bool first = true;
+    for (const auto& [plugin, presets] : data) {
+        if (!first) cursor = WriteText(cursor, kSeparator);
+        first = false;
+
+        cursor = WriteText(cursor, kPluginOpen);
+        cursor = WriteText(cursor, names.escaped(plugin));
+        cursor = WriteText(cursor, kPluginClose);
+
+        bool firstPreset = true;
+        for (NameId preset : presets) {
+            if (!firstPreset) cursor = WriteText(cursor, kSeparator);
+            firstPreset = false;
+
+            cursor = WriteText(cursor, kPresetOpen);
+            cursor = WriteText(cursor, names.escaped(preset));
+            cursor = WriteText(cursor, kPresetClose);
+        }
+
+        cursor = WriteText(cursor, kArrayClose);
+    }
+
+    WriteText(cursor, kSectionClose);
+    return text;
+}
+
+SerializedSections SerializeSections(const std::map<std::string, OrderedPluginData>& processedData,
+                                     const NameTable& names) {
+    SerializedSections sections;
+    const RuleKeySet& validKeys = GetValidRuleKeys();
+    for (const auto& [key, data] : processedData) {
+        if (validKeys.contains(key) && SectionChanged(data)) {
+            sections.values.emplace(key, SerializeSection(data, names));
+        }
+    }
+    return sections;
+}
+
+// ===== PARSER JSON CONSERVADOR CON FORMATO DE 4 ESPACIOS =====
+
+// ===== ÍNDICE DE SECCIONES DE NIVEL SUPERIOR =====
+// Un único recorrido del JSON registra dónde empieza y termina el valor de cada clave del objeto raíz.
+// Sólo se miran las claves de primer nivel, así que un nombre de plugin o preset igual a una clave
+// (p. ej. "npc" dentro de otra sección) nunca se confunde con la sección. Cadenas y contenedores se
+// atraviesan saltando por las posiciones del escáner estructural, sin volver a leer sus bytes.
+
+namespace {
+size_t SkipJsonWhitespace(std::string_view json, size_t pos) {
+    while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) pos++;
+    return pos;
+}
+
+// Avanza por las posiciones estructurales en el mismo sentido que el recorrido del objeto raíz
+class StructuralCursor {
+public:
+    StructuralCursor(std::string_view json, const std::vector<uint32_t>& positions)
+        : json(json), positions(positions) {}
+
+    // true si el byte en pos es estructural (no está escapado); deja el cursor sobre él
+    bool seek(size_t pos) {
+        while (next < positions.size() && positions[next] < pos) next++;
+        return next < positions.size() && positions[next] == pos;
+    }
+
+    // Tras seek() sobre una comilla: posición de la siguiente comilla no escapada (o size si no hay). Si
+    // la comilla abre una cadena es la posición siguiente; tras un JSON dañado el llamador puede estar
+    // sobre una de cierre, y se toma la siguiente comilla como siempre.
+    size_t stringEnd() const {
+        for (size_t k = next + 1; k < positions.size(); k++) {
+            if (json[positions[k]] == '"') return positions[k];
+        }
+        return json.size();
+    }
+
+    // Tras seek() sobre '{' o '[': un byte después de su cierre (o size si no hay)
+    size_t containerEnd() {
+        int depth = 0;
+        for (; next < positions.size(); next++) {
+            char c = json[positions[next]];
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return positions[next] + 1;
+            }
+        }
+        return json.size();
+    }
+
+private:
+    std::string_view json;
+    const std::vector<uint32_t>& positions;
+    size_t next = 0;
+};
+
+// Devuelve un byte después del final del valor que empieza en pos
+size_t FindJsonValueEnd(std::string_view json, size_t pos, StructuralCursor& cursor) {
+    if (pos >= json.size()) return pos;
+
+    if (json[pos] == '"' || json[pos] == '{' || json[pos] == '[') {
+        if (!cursor.seek(pos)) return pos;  // Carácter escapado fuera de una cadena: no abre nada
+        if (json[pos] == '"') {
+            return std::min(cursor.stringEnd() + 1, json.size());
+        }
+        return cursor.containerEnd();
+    }
+
+    // Escalar: hasta el siguiente separador del objeto raíz
+    while (pos < json.size() && json[pos] != ',' && json[pos] != '}' &&
+           !std::isspace(static_cast<unsigned char>(json[pos]))) {
+        pos++;
+    }
+    return pos;
+}
+}  // namespace
+
+JsonSectionIndex IndexTopLevelSections(std::string_view json) {
+    JsonSectionIndex index;
+    JsonStructuralIndex structure = ScanJsonStructure(json);
+    StructuralCursor cursor(json, structure.positions);
+
+    size_t pos = SkipJsonWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '{') return index;
+    pos++;
+
+    while (true) {
+        pos = SkipJsonWhitespace(json, pos);
+        if (pos >= json.size() || json[pos] != '"' || !cursor.seek(pos)) break;
+
+        size_t keyEnd = cursor.stringEnd();
+        if (keyEnd >= json.size()) break;
+        JsonSectionSpan section;
+        section.key = json.substr(pos + 1, keyEnd - pos - 1);
+
+        pos = SkipJsonWhitespace(json, keyEnd + 1);
+        if (pos >= json.size() || json[pos] != ':') break;
+
+        section.valueStart = SkipJsonWhitespace(json, pos + 1);
+        section.valueEnd = FindJsonValueEnd(json, section.valueStart, cursor);
+        index.sections.push_back(section);
+
+        pos = SkipJsonWhitespace(json, section.valueEnd);
+        if (pos >= json.size() || json[pos] != ',') break;
+        pos++;
+    }
+
+    return index;
+}
+
+// ===== COMPOSICIÓN DEL JSON ACTUALIZADO EN UNA PASADA =====
+// Sólo se reemplazan los valores de tipo objeto de las claves con datos. El resultado se escribe de
+// principio a fin copiando los tramos intactos del original y las secciones nuevas, sin desplazar
+// el buffer en cada reemplazo.
+
+std::string PreserveOriginalSections(const std::string& originalJson, const JsonSectionIndex& sectionIndex,
+                                     const SerializedSections& sections, AsyncLog& logFile) {
+    try {
+        struct Splice {
+            size_t start;
+            size_t end;
+            const std::string* text;
+        };
+
+        std::vector<Splice> splices;
+        splices.reserve(sections.values.size());
+        size_t resultSize = originalJson.size();
+
+        // Solo modificar las claves válidas que cambiaron (las únicas presentes en sections)
+        for (const auto& [key, sectionText] : sections.values) {
+            const JsonSectionSpan* span = sectionIndex.find(key);
+            if (span == nullptr || span->valueStart >= originalJson.size() || originalJson[span->valueStart] != '{') {
+                continue;
+            }
+
+            splices.push_back({span->valueStart, span->valueEnd, &sectionText});
+            resultSize = resultSize - (span->valueEnd - span->valueStart) + sectionText.size();
+            logFile << "INFO: Successfully updated key '" << key << "' with proper 4-space indentation"
+                    << std::endl;
+        }
+
+        std::sort(splices.begin(), splices.end(),
+                  [](const Splice& a, const Splice& b) { return a.start < b.start; });
+
+        std::string result;
+        result.reserve(resultSize);
+        size_t copied = 0;
+        for (const auto& splice : splices) {
+            result.append(originalJson, copied, splice.start - copied);
+            result.append(*splice.text);
+            copied = splice.end;
+        }
+        result.append(originalJson, copied, std::string::npos);
+
+        return result;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in PreserveOriginalSections: " << e.what() << std::endl;
+        return originalJson;  // Fallback al original
+    } catch (...) {
+        logFile.error() << "ERROR in PreserveOriginalSections: Unknown exception" << std::endl;
+        return originalJson;  // Fallback al original
+    }
+}
+
+// ===== PARSEAR DATOS EXISTENTES DEL JSON =====
+// Los nombres se guardan sin escapar; sólo los que contienen '\\' necesitan una copia decodificada
+
+NameId InternJsonString(std::string_view raw, NameTable& names) {
+    if (raw.find('\\') == std::string_view::npos) {
+        return names.intern(raw);
+    }
+    return names.intern(UnescapeJson(raw));
+}
+
+std::vector<std::pair<NameId, std::vector<NameId>>> parseOrderedPlugins(std::string_view content, NameTable& names) {
+    std::vector<std::pair<NameId, std::vector<NameId>>> result;
+    if (content.empty()) return result;
+
+    const char* str = content.data();
+    size_t len = content.length();
+    size_t pos = 0;
+    const size_t maxIters = 100000;
+    size_t iter = 0;
+
+    result.reserve(200);
+
+    try {
+        // El final de cada cadena sale del índice estructural: no se recorren sus bytes
+        JsonStructuralIndex structure = ScanJsonStructure(content);
+        StructuralCursor cursor(content, structure.positions);
+
+        while (pos < len && iter++ < maxIters) {
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len) break;
+
+            if (str[pos] != '"' || !cursor.seek(pos)) {
+                ++pos;
+                continue;
+            }
+
+            size_t keyStart = pos + 1;
+            pos = cursor.stringEnd();
+            if (pos >= len) break;
+
+            std::string_view plugin = content.substr(keyStart, pos - keyStart);
+            ++pos;  // skip closing "
+
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len || str[pos] != ':') {
+                ++pos;
+                continue;
+            }
+
+            ++pos;  // skip :
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len || str[pos] != '[') {
+                ++pos;
+                continue;
+            }
+
+            ++pos;  // skip [
+
+            std::vector<NameId> presets;
+            presets.reserve(50);
+            size_t presetIter = 0;
+
+            while (pos < len && presetIter++ < maxIters) {
+                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+                if (pos >= len) break;
+
+                if (str[pos] == ']') {
+                    ++pos;  // skip ]
+                    break;
+                }
+
+                if (str[pos] != '"' || !cursor.seek(pos)) {
+                    ++pos;
+                    continue;
+                }
+
+                size_t presetStart = pos + 1;
+                pos = cursor.stringEnd();
+                if (pos >= len) break;
+
+                presets.push_back(InternJsonString(content.substr(presetStart, pos - presetStart), names));
+                ++pos;  // skip closing "
+
+                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+                if (pos < len && str[pos] == ',') {
+                    ++pos;  // skip ,
+                    while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+                }
+            }
+
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos < len && str[pos] == ',') ++pos;
+
+            if (!plugin.empty()) {
+                result.emplace_back(InternJsonString(plugin, names), std::move(presets));
+            }
+        }
+    } catch (...) {
+        // En caso de error, retornar lo que se haya parseado
+    }
+
+    return result;
+}
+// ===== NUEVA FUNCIÓN: VERIFICACIÓN DE CAMBIOS NECESARIOS =====
+
+/**
+ * @brief Indica si alguna sección cambió respecto a como se leyó del JSON.
+ *
+ * Compara el hash canónico de origen de cada una de las 8 claves de configuración con el de su
+ * contenido después de aplicar las reglas INI. Las secciones que ninguna regla tocó conservan su hash
+ * de la carga y no se recalculan.
+ *
+ * @param processedData Las secciones después de aplicar las reglas de los archivos INI.
+ * @return true si se detectaron cambios y se necesita escribir en el archivo, false en caso contrario.
+ */
+bool CheckIfChangesNeeded(const std::map<std::string, OrderedPluginData>& processedData) {
+    const RuleKeySet& validKeys = GetValidRuleKeys();
+    for (const auto& [key, data] : processedData) {
+        if (validKeys.contains(key) && SectionChanged(data)) {
+            return true; // Se necesita escribir
+        }
+    }
+
+    // Si el bucle termina sin encontrar diferencias, no hay cambios.
+    return false; // No se necesita escribir
+}
+
+void LoadSectionsFromJson(std::string_view json, const JsonSectionIndex& sectionIndex,
+                          std::map<std::string, OrderedPluginData>& processedData, NameTable& names) {
+    // Parsear solo las 8 claves válidas
+    const std::vector<std::string> validKeys = {"npcFormID",       "npc",           "factionFemale", "factionMale",
+                                                "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+    // Las secciones se localizan en el nivel superior: una clave anidada con el mismo nombre no cuenta
+    for (const auto& key : validKeys) {
+        OrderedPluginData& data = processedData[key];
+        data = OrderedPluginData();
+
+        const JsonSectionSpan* span = sectionIndex.find(key);
+        if (span == nullptr || span->valueEnd - span->valueStart < 2 || json[span->valueStart] != '{' ||
+            json[span->valueEnd - 1] != '}') {
+            continue;
+        }
+
+        std::string_view keyContent = json.substr(span->valueStart + 1, span->valueEnd - span->valueStart - 2);
+        auto orderedPlugins = parseOrderedPlugins(keyContent, names);
+
+        for (const auto& p : orderedPlugins) {
+            for (const auto& preset : p.second) {
+                data.addPreset(p.first, preset);
+            }
+        }
+
+        // Hash de la sección tal como está escrita y de lo que quedó cargado
+        data.sourceHash = HashSectionEntries(orderedPlugins);
+        RefreshSectionHash(data);
+    }
+}
+
+bool ReadCompleteJson(const fs::path& jsonPath, std::string& jsonContent,
+                      std::map<std::string, OrderedPluginData>& processedData, NameTable& names,
+                      JsonSectionIndex& sectionIndex, AsyncLog& logFile) {
+    sectionIndex = JsonSectionIndex();
+    try {
+        if (!fs::exists(jsonPath)) {
+            logFile.error() << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
+            return false;
+        }
+
+        // Se valida y parsea el buffer compartido del pipeline: el archivo no se vuelve a abrir aquí. La
+        // validación entrega además el índice de secciones, así que no hace falta otro recorrido.
+        if (!PerformTripleValidation(jsonContent, logFile, &sectionIndex)) {
+            logFile.error() << "ERROR: JSON integrity check failed" << std::endl;
+            return false;
+        }
+
+        logFile << "Reading existing JSON from: " << jsonPath.string() << std::endl;
+
+        const size_t maxFileSize = 50 * 1024 * 1024;  // 50MB
+        if (jsonContent.size() > maxFileSize) {
+            logFile.error() << "WARNING: JSON file is very large (" << jsonContent.size() << " bytes), limiting to "
+                            << maxFileSize << " bytes" << std::endl;
+            jsonContent.resize(maxFileSize);
+            sectionIndex = IndexTopLevelSections(jsonContent);
+        }
+
+        if (jsonContent.empty() || jsonContent.size() < 2) {
+            logFile.error() << "ERROR: JSON file is empty or too small after reading" << std::endl;
+            return false;
+        }
+
+        LoadSectionsFromJson(jsonContent, sectionIndex, processedData, names);
+
+        // Log de lo que se cargó
+        logFile << "Loaded existing data from JSON:" << std::endl;
+        for (const auto& [key, data] : processedData) {
+            size_t count = data.getTotalPresetCount();
+            if (count > 0) {
+                logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count << " presets"
+                        << std::endl;
+            }
+        }
+        logFile << std::endl;
+
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in ReadCompleteJson: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in ReadCompleteJson: Unknown exception occurred" << std::endl;
+        return false;
+    }
+}
+
+// ===== ESCRITURA ATÓMICA ULTRA-SEGURA =====
+
+// Escribe content de una vez, en bloques grandes, calculando el checksum de lo escrito sobre la marcha
+bool WriteFileWithChecksum(const fs::path& filePath, std::string_view content, uint64_t& checksum) {
+    constexpr size_t kChunkSize = 1024 * 1024;
+
+    std::ofstream file(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) return false;
+
+    checksum = kFnvOffsetBasis;
+    for (size_t offset = 0; offset < content.size(); offset += kChunkSize) {
+        std::string_view chunk = content.substr(offset, kChunkSize);
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        if (!file) return false;
+        checksum = HashBytes(chunk, checksum);
+    }
+
+    file.close();
+    return !file.fail();
+}
+
+// Reemplaza targetPath por content a través de tempPath. content ya está validado: aquí sólo se
+// comprueba que el archivo temporal y el final tengan exactamente el tamaño escrito.
+ReplaceFileResult ReplaceFileVerified(const fs::path& targetPath, const fs::path& tempPath, std::string_view content,
+                                      WrittenContent& written, AsyncLog& logFile) {
+    uint64_t checksum = 0;
+    if (!WriteFileWithChecksum(tempPath, content, checksum)) {
+        logFile.error() << "ERROR: Failed to write temporary file: " << tempPath.filename().string() << std::endl;
+        std::error_code removeError;
+        fs::remove(tempPath, removeError);
+        return ReplaceFileResult::WriteFailed;
+    }
+
+    std::error_code ec;
+    if (fs::file_size(tempPath, ec) != content.size() || ec) {
+        logFile.error() << "ERROR: Temporary file is incomplete: " << tempPath.filename().string() << std::endl;
+        std::error_code removeError;
+        fs::remove(tempPath, removeError);
+        return ReplaceFileResult::WriteFailed;
+    }
+
+    fs::rename(tempPath, targetPath, ec);
+    if (ec) {
+        logFile.error() << "ERROR: Failed to move temporary file to final location: " << ec.message() << std::endl;
+        std::error_code removeError;
+        fs::remove(tempPath, removeError);
+        return ReplaceFileResult::MoveFailed;
+    }
+
+    // Verificación final: el contenido se validó antes de escribir, basta con confirmar el tamaño
+    auto finalSize = fs::file_size(targetPath, ec);
+    if (ec || finalSize != content.size()) {
+        logFile.error() << "ERROR: Final file size does not match the written content: "
+                        << targetPath.filename().string() << std::endl;
+        return ReplaceFileResult::VerifyFailed;
+    }
+
+    written.size = content.size();
+    written.checksum = checksum;
+    written.known = true;
+    return ReplaceFileResult::Replaced;
+}
+
+bool WriteJsonAtomically(const fs::path& jsonPath, const std::string& content, const BackupStore& store,
+                         WrittenContent& written, AsyncLog& logFile) {
+    try {
+        // Validar el contenido nuevo en memoria antes de tocar el disco
+        if (!PerformTripleValidation(content, logFile)) {
+            logFile.error() << "ERROR: New JSON content failed integrity check, nothing was written!" << std::endl;
+            SaveRejectedJsonToAnalysis(content, store, logFile);
+            return false;
+        }
+
+        // Escribir a archivo temporal primero y moverlo al destino final
+        fs::path tempPath = jsonPath;
+        tempPath.replace_extension(".tmp");
+
+        ReplaceFileResult replaced = ReplaceFileVerified(jsonPath, tempPath, content, written, logFile);
+        if (replaced == ReplaceFileResult::VerifyFailed) {
+            // Sólo aquí se sustituyó el JSON: el archivo final no es el que se escribió
+            logFile.error() << "ERROR: Final JSON file failed integrity check!" << std::endl;
+            if (fs::exists(jsonPath)) {
+                MoveCorruptedJsonToAnalysis(jsonPath, store, logFile);
+            }
+            return false;
+        }
+        if (replaced != ReplaceFileResult::Replaced) {
+            // El JSON en disco no se llegó a tocar: sigue siendo el original válido
+            logFile.error() << "ERROR: Could not write the JSON file, the original was left unchanged!" << std::endl;
+            return false;
+        }
+
+        logFile << "SUCCESS: JSON file written atomically and verified!" << std::endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in WriteJsonAtomically: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "ERROR in WriteJsonAtomically: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== INGESTA PARALELA DE ARCHIVOS DE REGLAS INI =====
+// Cada archivo OBodyNG_PDA_*.ini se lee y se parsea en un hilo del pool a su propia lista de reglas.
+// La aplicación posterior recorre las listas en el orden del escaneo, así que el resultado es idéntico
+// al de una ejecución en serie.
+
+std::vector<fs::path> CollectRuleFilePaths(const fs::path& dataPath, AsyncLog& logFile) {
+    std::vector<fs::path> ruleFilePaths;
+    try {
+        for (const auto& entry : fs::directory_iterator(dataPath)) {
+            if (entry.is_regular_file()) {
+                std::string filename = entry.path().filename().string();
+                if (filename.starts_with("OBodyNG_PDA_") && filename.ends_with(".ini")) {
+                    ruleFilePaths.push_back(entry.path());
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR scanning directory: " << e.what() << std::endl;
+    }
+    return ruleFilePaths;
+}
+
+// Se rellena en el sitio (no se devuelve por valor): las reglas son vistas sobre ruleFile.content y un
+// std::string corto movido cambiaría de dirección
+void IngestRuleFile(const fs::path& iniPath, const RuleKeySet& validKeys, IniRuleFile& ruleFile) {
+    ruleFile.path = iniPath;
+    ruleFile.filename = iniPath.filename().string();
+
+    try {
+        std::ifstream iniFile(iniPath, std::ios::binary);
+        if (!iniFile.is_open()) {
+            return;
+        }
+        ruleFile.content.assign(std::istreambuf_iterator<char>(iniFile), std::istreambuf_iterator<char>());
+        iniFile.close();
+        ruleFile.opened = true;
+        ruleFile.rules.reserve(100);
+
+        std::string_view content = ruleFile.content;
+        size_t lineStart = 0;
+        for (size_t lineIndex = 0; lineStart < content.size(); lineIndex++) {
+            size_t lineEnd = content.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos) lineEnd = content.size();
+            std::string_view line = content.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+
+            // Eliminar comentarios
+            line = line.substr(0, line.find(';'));
+            line = line.substr(0, line.find('#'));
+
+            // Buscar el signo =
+            size_t equalPos = line.find('=');
+            if (equalPos != std::string_view::npos) {
+                std::string_view key = TrimView(line.substr(0, equalPos));
+                std::string_view value = TrimView(line.substr(equalPos + 1));
+
+                if (validKeys.contains(key) && !value.empty()) {
+                    ParsedRule rule = ParseRuleLine(key, value);
+                    if (!rule.plugin.empty() && !rule.presets.empty()) {
+                        ruleFile.rules.push_back({lineIndex, std::move(rule)});
+                    }
+                }
+            }
+        }
+    } catch (...) {
+        ruleFile.opened = false;
+        ruleFile.rules.clear();
+    }
+}
+
+std::vector<IniRuleFile> IngestRuleFilesParallel(const std::vector<fs::path>& iniPaths,
+                                                 const RuleKeySet& validKeys, NameTable& names) {
+    std::vector<IniRuleFile> ruleFiles(iniPaths.size());
+
+    size_t workerCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 8);
+    workerCount = std::min(workerCount, iniPaths.size());
+
+    std::atomic<size_t> nextFile{0};
+    auto worker = [&]() {
+        for (size_t i = nextFile.fetch_add(1); i < iniPaths.size(); i = nextFile.fetch_add(1)) {
+            IngestRuleFile(iniPaths[i], validKeys, ruleFiles[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount - 1);
+    try {
+        for (size_t i = 1; i < workerCount; i++) {
+            workers.emplace_back(worker);
+        }
+    } catch (...) {
+        // Si no se pueden crear más hilos, los que ya existen y el hilo actual terminan el trabajo
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    // La compilación interna los nombres en la tabla de la ejecución: se hace en serie y en orden
+    for (auto& ruleFile : ruleFiles) {
+        CompileRuleFile(ruleFile, names);
+    }
+
+    return ruleFiles;
+}
+
+// ===== ACTUALIZACIÓN EN LOTE DE CONTADORES INI (UNA PASADA, REEMPLAZO ATÓMICO) =====
+
+bool UpdateIniRuleCounts(const fs::path& iniPath, const std::string& content,
+                         const std::vector<IniCountUpdate>& updates, AsyncLog& logFile, uint64_t* bytesWritten) {
+    if (updates.empty()) return true;
+
+    try {
+        // El contenido llega tal como se leyó en la ingesta (modo binario): se conservan los finales
+        // de línea, los comentarios y el formato original sin volver a leer el archivo
+        std::string output;
+        output.reserve(content.size() + updates.size() * 4);
+
+        // Las actualizaciones llegan en el orden de lectura; se identifican por número de línea
+        size_t nextUpdate = 0;
+        size_t lineIndex = 0;
+        size_t lineStart = 0;
+        bool modified = false;
+
+        while (lineStart < content.size()) {
+            size_t lineEnd = content.find('\n', lineStart);
+            if (lineEnd == std::string::npos) lineEnd = content.size();
+
+            while (nextUpdate < updates.size() && updates[nextUpdate].lineIndex < lineIndex) nextUpdate++;
+
+            if (nextUpdate < updates.size() && updates[nextUpdate].lineIndex == lineIndex) {
+                std::string_view fileLine(content.data() + lineStart, lineEnd - lineStart);
+
+                // Zona de código: todo lo anterior al primer comentario (';' o '#')
+                size_t codeEnd = std::min(fileLine.find(';'), fileLine.find('#'));
+                if (codeEnd == std::string_view::npos) codeEnd = fileLine.size();
+                std::string_view code = fileLine.substr(0, codeEnd);
+
+                size_t lastPipe = code.rfind('|');
+                if (lastPipe != std::string_view::npos) {
+                    size_t valueEnd = code.find_last_not_of(" \t\r\n");
+                    valueEnd = (valueEnd == std::string_view::npos || valueEnd < lastPipe) ? lastPipe + 1 : valueEnd + 1;
+
+                    std::string count = std::to_string(updates[nextUpdate].newCount);
+                    if (fileLine.substr(lastPipe + 1, valueEnd - lastPipe - 1) != count) {
+                        modified = true;
+                    }
+
+                    output.append(fileLine.substr(0, lastPipe + 1));
+                    output.append(count);
+                    output.append(fileLine.substr(valueEnd));
+                } else {
+                    output.append(fileLine);
+                }
+            } else {
+                output.append(content, lineStart, lineEnd - lineStart);
+            }
+
+            if (lineEnd < content.size()) output.push_back('\n');
+            lineStart = lineEnd + 1;
+            lineIndex++;
+        }
+
+        if (!modified) return true;
+
+        // Escribir a un temporal y reemplazar el INI de una sola vez
+        fs::path tempPath = iniPath;
+        tempPath += ".tmp";
+
+        std::ofstream outFile(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!outFile.is_open()) {
+            logFile.error() << "  ERROR: Could not create temporary INI file: " << tempPath.filename().string()
+                            << std::endl;
+            return false;
+        }
+
+        outFile.write(output.data(), output.size());
+        outFile.close();
+
+        if (outFile.fail()) {
+            logFile.error() << "  ERROR: Failed to write temporary INI file: " << tempPath.filename().string()
+                            << std::endl;
+            try {
+                fs::remove(tempPath);
+            } catch (...) {
+            }
+            return false;
+        }
+
+        std::error_code ec;
+        fs::rename(tempPath, iniPath, ec);
+        if (ec) {
+            logFile.error() << "  ERROR: Failed to replace INI with updated counters: " << ec.message() << std::endl;
+            try {
+                fs::remove(tempPath);
+            } catch (...) {
+            }
+            return false;
+        }
+
+        if (bytesWritten != nullptr) {
+            *bytesWritten += output.size();
+        }
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "  ERROR in UpdateIniRuleCounts: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile.error() << "  ERROR in UpdateIniRuleCounts: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== CACHÉ INCREMENTAL DE EJECUCIÓN (HUELLAS DE ENTRADA/SALIDA) =====
+// Si el JSON y todos los OBodyNG_PDA_*.ini siguen exactamente como quedaron al final de la última
+// ejecución completa, aplicar las reglas otra vez no cambiaría nada: la ejecución se omite.
+// Primero se compara tamaño y fecha de modificación; el hash de contenido sólo se calcula cuando
+// el tamaño coincide pero la fecha no.
+
+const char* const kRunCacheFormatVersion = "1";
+
+uint64_t HashBytes(std::string_view data, uint64_t hash) {
+    // FNV-1a de 64 bits
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool HashFileContent(const fs::path& filePath, uint64_t& hash) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    hash = HashBytes({});
+    std::vector<char> chunk(1 << 16);
+    while (file) {
+        file.read(chunk.data(), chunk.size());
+        std::streamsize readCount = file.gcount();
+        if (readCount <= 0) break;
+        hash = HashBytes(std::string_view(chunk.data(), static_cast<size_t>(readCount)), hash);
+    }
+    return !file.bad();
+}
+
+bool StatFingerprint(const fs::path& filePath, FileFingerprint& fingerprint) {
+    std::error_code ec;
+    fingerprint.name = filePath.filename().string();
+    fingerprint.size = fs::file_size(filePath, ec);
+    if (ec) return false;
+    auto modified = fs::last_write_time(filePath, ec);
+    if (ec) return false;
+    fingerprint.modified = static_cast<long long>(modified.time_since_epoch().count());
+    return true;
+}
+
+bool ComputeFingerprint(const fs::path& filePath, FileFingerprint& fingerprint) {
+    return StatFingerprint(filePath, fingerprint) && HashFileContent(filePath, fingerprint.hash);
+}
+
+bool FingerprintMatches(const fs::path& filePath, const FileFingerprint& recorded) {
+    FileFingerprint current;
+    if (!StatFingerprint(filePath, current)) return false;
+    if (current.name != recorded.name || current.size != recorded.size) return false;
+    if (current.modified == recorded.modified) return true;
+
+    // Misma longitud pero fecha distinta (p. ej. el archivo se copió o se guardó sin cambios)
+    uint64_t hash = 0;
+    return HashFileContent(filePath, hash) && hash == recorded.hash;
+}
+
+std::string FormatFingerprint(const FileFingerprint& fingerprint) {
+    std::ostringstream line;
+    line << fingerprint.name << "|" << fingerprint.size << "|" << fingerprint.modified << "|" << std::hex
+         << std::setw(16) << std::setfill('0') << fingerprint.hash;
+    return line.str();
+}
+
+bool ParseFingerprint(std::string_view value, FileFingerprint& fingerprint) {
+    // El nombre puede contener '|' en teoría: se separan los tres últimos campos desde el final
+    size_t hashPos = value.rfind('|');
+    if (hashPos == std::string::npos || hashPos == 0) return false;
+    size_t modifiedPos = value.rfind('|', hashPos - 1);
+    if (modifiedPos == std::string::npos || modifiedPos == 0) return false;
+    size_t sizePos = value.rfind('|', modifiedPos - 1);
+    if (sizePos == std::string::npos) return false;
+
+    auto parseField = [](std::string_view field, auto& result, int base) {
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), result, base);
+        return error == std::errc() && end == field.data() + field.size();
+    };
+
+    fingerprint.name = std::string(value.substr(0, sizePos));
+    return parseField(value.substr(sizePos + 1, modifiedPos - sizePos - 1), fingerprint.size, 10) &&
+           parseField(value.substr(modifiedPos + 1, hashPos - modifiedPos - 1), fingerprint.modified, 10) &&
+           parseField(value.substr(hashPos + 1), fingerprint.hash, 16);
+}
+
+bool LoadRunCacheManifest(const fs::path& manifestPath, RunCacheManifest& manifest) {
+    try {
+        std::ifstream manifestFile(manifestPath);
+        if (!manifestFile.is_open()) return false;
+
+        bool versionMatches = false;
+        bool hasOutput = false;
+        std::string line;
+        while (std::getline(manifestFile, line)) {
+            size_t equalPos = line.find('=');
+            if (equalPos == std::string::npos) continue;
+            std::string_view key = TrimView(std::string_view(line).substr(0, equalPos));
+            std::string_view value = TrimView(std::string_view(line).substr(equalPos + 1));
+
+            if (key == "Version") {
+                versionMatches = (value == kRunCacheFormatVersion);
+            } else if (key == "Output") {
+                hasOutput = ParseFingerprint(value, manifest.output);
+            } else if (key == "Ini") {
+                FileFingerprint fingerprint;
+                if (!ParseFingerprint(value, fingerprint)) return false;
+                manifest.ruleFiles.push_back(std::move(fingerprint));
+            }
+        }
+        return versionMatches && hasOutput;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool SaveRunCacheManifest(const fs::path& manifestPath, const RunCacheManifest& manifest, AsyncLog& logFile) {
+    try {
+        std::ostringstream content;
+        content << "; Generated by OBody NG Preset Distribution Assistant NG - do not edit." << '\n';
+        content << "; Delete this file or set ForceRun in the plugin INI to force a full run." << '\n';
+        content << "[Run cache]" << '\n';
+        content << "Version = " << kRunCacheFormatVersion << '\n';
+        content << "Output = " << FormatFingerprint(manifest.output) << '\n';
+        for (const auto& fingerprint : manifest.ruleFiles) {
+            content << "Ini = " << FormatFingerprint(fingerprint) << '\n';
+        }
+
+        fs::path tempPath = manifestPath;
+        tempPath += ".tmp";
+        std::ofstream manifestFile(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!manifestFile.is_open()) {
+            logFile.error() << "WARNING: Could not write run cache manifest" << std::endl;
+            return false;
+        }
+        manifestFile << content.str();
+        manifestFile.close();
+
+        std::error_code ec;
+        if (manifestFile.fail()) {
+            fs::remove(tempPath, ec);
+            logFile.error() << "WARNING: Could not write run cache manifest" << std::endl;
+            return false;
+        }
+        fs::rename(tempPath, manifestPath, ec);
+        if (ec) {
+            fs::remove(tempPath, ec);
+            logFile.error() << "WARNING: Could not replace run cache manifest" << std::endl;
+            return false;
+        }
+        return true;
+    } catch (...) {
+        logFile.error() << "WARNING: Could not write run cache manifest" << std::endl;
+        return false;
+    }
+}
+
+void InvalidateRunCache(const fs::path& manifestPath) {
+    std::error_code ec;
+    fs::remove(manifestPath, ec);
+}
+
+bool IsRunCacheValid(const fs::path& manifestPath, const fs::path& jsonPath, const std::vector<fs::path>& ruleFilePaths,
+                     AsyncLog& logFile) {
+    RunCacheManifest manifest;
+    if (!LoadRunCacheManifest(manifestPath, manifest)) {
+        logFile << "Run cache: no valid manifest found, full run required" << std::endl;
+        return false;
+    }
+
+    if (!FingerprintMatches(jsonPath, manifest.output)) {
+        logFile << "Run cache: JSON changed since last run" << std::endl;
+        return false;
+    }
+
+    // El orden importa: las reglas se aplican en el orden del escaneo
+    if (manifest.ruleFiles.size() != ruleFilePaths.size()) {
+        logFile << "Run cache: set of OBodyNG_PDA_*.ini files changed (" << manifest.ruleFiles.size() << " -> "
+                << ruleFilePaths.size() << ")" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < ruleFilePaths.size(); i++) {
+        if (!FingerprintMatches(ruleFilePaths[i], manifest.ruleFiles[i])) {
+            logFile << "Run cache: " << ruleFilePaths[i].filename().string() << " changed since last run"
+                    << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RecordRunCache(const fs::path& manifestPath, const fs::path& jsonPath, const WrittenContent& output,
+                    const std::vector<fs::path>& ruleFilePaths, AsyncLog& logFile) {
+    RunCacheManifest manifest;
+
+    // Si el pipeline conoce el checksum de lo que dejó en disco (y el tamaño coincide) no se relee el JSON
+    bool outputKnown = output.known && StatFingerprint(jsonPath, manifest.output) && manifest.output.size == output.size;
+    if (outputKnown) {
+        manifest.output.hash = output.checksum;
+    } else if (!ComputeFingerprint(jsonPath, manifest.output)) {
+        InvalidateRunCache(manifestPath);
+        return false;
+    }
+
+    manifest.ruleFiles.reserve(ruleFilePaths.size());
+    for (const auto& iniPath : ruleFilePaths) {
+        FileFingerprint fingerprint;
+        if (!ComputeFingerprint(iniPath, fingerprint)) {
+            InvalidateRunCache(manifestPath);
+            return false;
+        }
+        manifest.ruleFiles.push_back(std::move(fingerprint));
+    }
+
+    return SaveRunCacheManifest(manifestPath, manifest, logFile);
+}
+
+// ===== CLAVES DE DISTRIBUCIÓN ADMITIDAS =====
+
+const RuleKeySet& GetValidRuleKeys() {
+    static const RuleKeySet validKeys = {
+        "npcFormID",       "npc",           "factionFemale", "factionMale",
+        "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+    return validKeys;
+}
+
+// ===== IR DE OPERACIONES DE REGLA =====
+// Cada línea de regla se compila una sola vez (tras la ingesta paralela) a una operación tipada con la
+// clave ya resuelta a un índice y los presets ya normalizados. El ejecutor recorre la lista de un
+// archivo como un lote, sin volver a interpretar los códigos de applyCount línea por línea.
+
+const std::vector<std::string>& GetRuleKeyList() {
+    static const std::vector<std::string> keyList(GetValidRuleKeys().begin(), GetValidRuleKeys().end());
+    return keyList;
+}
+
+int FindRuleKeyIndex(std::string_view key) {
+    const auto& keyList = GetRuleKeyList();
+    auto it = std::lower_bound(keyList.begin(), keyList.end(), key, std::less<>());
+    if (it == keyList.end() || *it != key) return -1;
+    return static_cast<int>(it - keyList.begin());
+}
+
+RuleOp CompileRuleOp(size_t lineIndex, const ParsedRule& rule, NameTable& names) {
+    RuleOp op;
+    op.keyIndex = static_cast<uint8_t>(std::max(0, FindRuleKeyIndex(rule.key)));
+    op.lineIndex = lineIndex;
+    op.plugin = names.intern(rule.plugin);
+    op.extra = std::string(rule.extra);
+
+    switch (rule.applyCount) {
+        case -1:
+            op.type = RuleOpType::Add;
+            break;
+        case -4:
+            op.type = RuleOpType::RemovePresets;
+            break;
+        case -2:
+            op.type = RuleOpType::RemovePresetsOnce;
+            op.counterAfter = 0;
+            break;
+        case -5:
+            op.type = RuleOpType::RemovePlugin;
+            break;
+        case -3:
+            op.type = RuleOpType::RemovePluginOnce;
+            op.counterAfter = 0;
+            break;
+        default:
+            if (rule.applyCount > 0) {
+                op.type = RuleOpType::AddCounted;
+                op.counterAfter = rule.applyCount - 1;
+            } else if (op.extra != "0") {
+                // Modo no reconocido: la regla se omite y su contador se normaliza a 0
+                op.type = RuleOpType::SkipInvalid;
+                op.counterAfter = 0;
+            } else {
+                op.type = RuleOpType::Skip;
+            }
+            break;
+    }
+
+    // En las eliminaciones el prefijo '!' es opcional: se quita aquí y no en cada aplicación
+    bool removal = op.type == RuleOpType::RemovePresets || op.type == RuleOpType::RemovePresetsOnce;
+    op.presets.reserve(rule.presets.size());
+    for (const auto& preset : rule.presets) {
+        NameId presetId = names.intern(preset);
+        op.presets.push_back(removal ? names.stripped(presetId) : presetId);
+    }
+
+    return op;
+}
+
+void CompileRuleFile(IniRuleFile& ruleFile, NameTable& names) {
+    ruleFile.ops.reserve(ruleFile.rules.size());
+    for (const auto& [lineIndex, rule] : ruleFile.rules) {
+        ruleFile.ops.push_back(CompileRuleOp(lineIndex, rule, names));
+    }
+    ruleFile.rules.clear();
+    ruleFile.rules.shrink_to_fit();
+}
+
+std::vector<OrderedPluginData*> ResolveRuleKeyData(std::map<std::string, OrderedPluginData>& processedData) {
+    std::vector<OrderedPluginData*> keyData;
+    keyData.reserve(GetRuleKeyList().size());
+    for (const auto& key : GetRuleKeyList()) {
+        keyData.push_back(&processedData[key]);
+    }
+    return keyData;
+}
+
+// ===== COALESCENCIA DE REGLAS POR (CLAVE, PLUGIN) =====
+
+RuleCoalescer::RuleCoalescer(std::map<std::string, OrderedPluginData>& processedData, const NameTable& names)
+    : names(names), keyData(ResolveRuleKeyData(processedData)), stateIndex(keyData.size()) {}
+
+RuleCoalescer::PluginState& RuleCoalescer::stateFor(const RuleOp& op) {
+    auto& index = stateIndex[op.keyIndex];
+    auto it = index.find(op.plugin);
+    if (it != index.end()) {
+        return states[it->second];
+    }
+
+    // Primera regla sobre este plugin: el estado local parte de lo que ya hay en el JSON
+    PluginState& state = states.emplace_back();
+    state.keyIndex = op.keyIndex;
+    state.plugin = op.plugin;
+    if (const auto* existing = keyData[op.keyIndex]->findPlugin(op.plugin)) {
+        state.exists = true;
+        state.entry.presets = existing->presets;
+        state.entry.presetIndex = existing->presetIndex;
+    }
+    index.emplace(state.plugin, states.size() - 1);
+    return state;
+}
+
+int RuleCoalescer::apply(const RuleOp& op) {
+    sequence++;
+
+    switch (op.type) {
+        case RuleOpType::Add:
+        case RuleOpType::AddCounted: {
+            PluginState& state = stateFor(op);
+            int presetsAdded = 0;
+            for (const auto& preset : op.presets) {
+                if (!state.exists) {
+                    // Como en OrderedPluginData::addPreset: el plugin (re)creado pasa al final del orden
+                    state.exists = true;
+                    state.createdAt = sequence;
+                }
+                if (state.entry.addPreset(preset)) {
+                    presetsAdded++;
+                }
+            }
+            state.changed = state.changed || presetsAdded > 0;
+            return presetsAdded;
+        }
+
+        case RuleOpType::RemovePresets:
+        case RuleOpType::RemovePresetsOnce: {
+            PluginState& state = stateFor(op);
+            int presetsRemoved = 0;
+            for (const auto& preset : op.presets) {
+                if (!state.exists) break;
+                if (state.entry.removePreset(preset, names)) {
+                    presetsRemoved++;
+                    // Quitar el último preset elimina el plugin, igual que en OrderedPluginData::removePreset
+                    if (state.entry.presets.empty()) {
+                        state.exists = false;
+                        state.entry.presetIndex.clear();
+                    }
+                }
+            }
+            state.changed = state.changed || presetsRemoved > 0;
+            return presetsRemoved;
+        }
+
+        case RuleOpType::RemovePlugin:
+        case RuleOpType::RemovePluginOnce: {
+            PluginState& state = stateFor(op);
+            if (!state.exists) return 0;
+            state.exists = false;
+            state.changed = true;
+            state.entry.presets.clear();
+            state.entry.presetIndex.clear();
+            return 1;
+        }
+
+        case RuleOpType::Skip:
+        case RuleOpType::SkipInvalid:
+            break;
+    }
+    return 0;
+}
+
+void RuleCoalescer::commit() {
+    std::vector<PluginState*> created;
+
+    for (auto& state : states) {
+        if (!state.changed) continue;
+        OrderedPluginData& data = *keyData[state.keyIndex];
+        NameId plugin = state.plugin;
+
+        if (state.createdAt != 0 || !state.exists) {
+            // Eliminado, o eliminado y vuelto a crear: la entrada original desaparece
+            if (data.removePlugin(plugin) && journal != nullptr) {
+                journal->push_back({true, state.keyIndex, plugin, {}});
+            }
+            if (state.exists) {
+                created.push_back(&state);
+            }
+        } else {
+            const auto* existing = data.findPlugin(plugin);
+            if (existing == nullptr || existing->presets != state.entry.presets) {
+                if (journal != nullptr) {
+                    journal->push_back({false, state.keyIndex, plugin, state.entry.presets});
+                }
+                data.assignPlugin(plugin, std::move(state.entry.presets), std::move(state.entry.presetIndex));
+            }
+        }
+    }
+
+    // Los plugins creados se añaden en el orden de su última creación, como con la aplicación directa
+    std::sort(created.begin(), created.end(),
+              [](const PluginState* a, const PluginState* b) { return a->createdAt < b->createdAt; });
+    for (PluginState* state : created) {
+        if (journal != nullptr) {
+            journal->push_back({false, state->keyIndex, state->plugin, state->entry.presets});
+        }
+        keyData[state->keyIndex]->assignPlugin(state->plugin, std::move(state->entry.presets),
+                                               std::move(state->entry.presetIndex));
+    }
+
+    states.clear();
+    for (auto& index : stateIndex) {
+        index.clear();
+    }
+}
+
+void ExecuteRuleOps(const std::vector<RuleOp>& ops, RuleCoalescer& coalescer, std::vector<IniCountUpdate>& counterUpdates,
+                    RuleApplyStats& stats, AsyncLog& logFile) {
+    const auto& keyList = GetRuleKeyList();
+    // Con el log por debajo de "detail" las líneas por regla ni siquiera se formatean
+    const bool detail = logFile.enabled(LogLevel::RuleDetail);
+
+    for (const RuleOp& op : ops) {
+        const std::string& key = keyList[op.keyIndex];
+        std::string_view plugin = coalescer.names.name(op.plugin);
+        int outcome = coalescer.apply(op);
+        stats.rulesProcessed++;
+
+        switch (op.type) {
+            case RuleOpType::Skip:
+                stats.rulesSkipped++;
+                if (detail) {
+                    logFile.detail() << "  Skipped (count=0): " << key << " -> Plugin: " << plugin << std::endl;
+                }
+                break;
+
+            case RuleOpType::SkipInvalid:
+                stats.rulesSkipped++;
+                if (detail) {
+                    logFile.detail() << "  Skipped (invalid mode detected in extra '" << op.extra
+                                     << "', setting to 0): " << key << " -> Plugin: " << plugin << std::endl;
+                }
+                break;
+
+            case RuleOpType::Add:
+            case RuleOpType::AddCounted: {
+                int presetsAdded = outcome;
+                if (presetsAdded > 0) {
+                    stats.rulesApplied++;
+                }
+                if (!detail) break;
+
+                if (presetsAdded > 0) {
+                    logFile.detail() << "  Applied: " << key << " -> Plugin: " << plugin << " -> Added "
+                                     << presetsAdded << " new presets";
+                    if (op.type == RuleOpType::AddCounted) {
+                        logFile << " (remaining count: " << op.counterAfter << ")";
+                    }
+                    if (!op.extra.empty()) {
+                        logFile << " (mode: " << op.extra << ")";
+                    }
+                    logFile << std::endl;
+                } else {
+                    logFile.detail() << "  No new presets added (all already exist): " << key
+                                     << " -> Plugin: " << plugin;
+                    if (op.type == RuleOpType::AddCounted) {
+                        logFile << " (remaining count: " << op.counterAfter << ")";
+                    }
+                    logFile << std::endl;
+                }
+                break;
+            }
+
+            case RuleOpType::RemovePresets:
+            case RuleOpType::RemovePresetsOnce: {
+                int presetsRemoved = outcome;
+                if (presetsRemoved > 0) {
+                    stats.rulesApplied++;
+                    stats.presetsRemoved += presetsRemoved;
+                }
+                if (!detail) break;
+
+                if (presetsRemoved > 0) {
+                    logFile.detail() << "  Applied: " << key << " -> Plugin: " << plugin << " -> Removed "
+                                     << presetsRemoved << " presets";
+                    if (!op.extra.empty()) {
+                        logFile << " (mode: " << op.extra << ")";
+                    }
+                    logFile << std::endl;
+                } else {
+                    logFile.detail() << "  No presets removed (not found): " << key << " -> Plugin: " << plugin
+                                     << std::endl;
+                }
+                break;
+            }
+
+            case RuleOpType::RemovePlugin:
+            case RuleOpType::RemovePluginOnce:
+                if (outcome > 0) {
+                    stats.rulesApplied++;
+                    stats.pluginsRemoved++;
+                }
+                if (!detail) break;
+
+                if (outcome > 0) {
+                    logFile.detail() << "  Applied: " << key << " -> Plugin: " << plugin
+                                     << " -> REMOVED ENTIRE PLUGIN";
+                    if (!op.extra.empty()) {
+                        logFile << " (mode: " << op.extra << ")";
+                    }
+                    logFile << std::endl;
+                } else {
+                    logFile.detail() << "  No plugin removed (not found): " << key << " -> Plugin: " << plugin
+                                     << std::endl;
+                }
+                break;
+        }
+
+        // Los modos de un solo uso y los contadores se reescriben se haya aplicado o no la regla
+        if (op.counterAfter >= 0) {
+            counterUpdates.push_back({op.lineIndex, op.counterAfter});
+        }
+    }
+}
+
+// ===== APLICACIÓN DE REGLAS COMPILADAS =====
+// Ejecuta el lote de operaciones de cada archivo en el orden del escaneo sobre el coalescedor y vuelca
+// el resultado neto al final. Con updateCounters = false los INI no se modifican, así la aplicación
+// puede repetirse (benchmark).
+
+void ApplyRuleFiles(const std::vector<IniRuleFile>& ruleFiles, std::map<std::string, OrderedPluginData>& processedData,
+                    const NameTable& names, RuleApplyStats& stats, bool updateCounters, AsyncLog& logFile,
+                    std::vector<JournalOp>* journal, RunReport* report) {
+    RuleCoalescer coalescer(processedData, names);
+    coalescer.journal = journal;
+    std::vector<IniCountUpdate> counterUpdates;
+
+    for (const auto& ruleFile : ruleFiles) {
+        logFile << std::endl << "Processing file: " << ruleFile.filename << std::endl;
+        stats.filesProcessed++;
+
+        if (!ruleFile.opened) {
+            logFile.error() << "  ERROR: Could not open file!" << std::endl;
+            continue;
+        }
+
+        RuleApplyStats fileStats;
+        RuleFileReport fileReport;
+        counterUpdates.clear();
+        {
+            ScopedStageTimer timer(report, "rule application");
+            ExecuteRuleOps(ruleFile.ops, coalescer, counterUpdates, fileStats, logFile);
+            fileReport.applyMilliseconds = timer.milliseconds();
+        }
+
+        // Actualizar todos los contadores del archivo INI en una sola pasada
+        if (updateCounters) {
+            ScopedStageTimer timer(report, "INI write-back");
+            UpdateIniRuleCounts(ruleFile.path, ruleFile.content, counterUpdates, logFile, &fileReport.bytesWritten);
+            fileReport.writeBackMilliseconds = timer.milliseconds();
+            timer.addWritten(fileReport.bytesWritten);
+        }
+
+        if (report != nullptr) {
+            fileReport.file = ruleFile.filename;
+            fileReport.bytesRead = ruleFile.content.size();
+            fileReport.rulesProcessed = fileStats.rulesProcessed;
+            fileReport.rulesApplied = fileStats.rulesApplied;
+            report->files.push_back(std::move(fileReport));
+        }
+
+        logFile << "  Rules in file: " << fileStats.rulesProcessed << " | Applied: " << fileStats.rulesApplied
+                << " | Skipped: " << fileStats.rulesSkipped << " | Presets removed: " << fileStats.presetsRemoved
+                << " | Plugins removed: " << fileStats.pluginsRemoved << std::endl;
+
+        stats.rulesProcessed += fileStats.rulesProcessed;
+        stats.rulesApplied += fileStats.rulesApplied;
+        stats.rulesSkipped += fileStats.rulesSkipped;
+        stats.presetsRemoved += fileStats.presetsRemoved;
+        stats.pluginsRemoved += fileStats.pluginsRemoved;
+    }
+
+    // Sólo el efecto neto de todas las reglas llega a los datos del JSON
+    ScopedStageTimer timer(report, "rule commit");
+    coalescer.commit();
+
+    // Las secciones tocadas recalculan su hash; las demás conservan el de la carga
+    for (auto& [key, data] : processedData) {
+        RefreshSectionHash(data);
+    }
+}
+
+// ===== DIARIO DE OPERACIONES =====
+// Formato (texto, sólo se añade al final; una ejecución sólo cuenta si llegó a escribir su línea "end"):
+//   run <id> <timestamp> <hash de partida> <hash resultante>
+//   = <clave> "<plugin>" "<preset>" ...      presets finales del plugin (al final de la sección si es nuevo)
+//   - <clave> "<plugin>"                     plugin eliminado
+//   end <id>
+// Los nombres se guardan escapados como en el JSON.
+
+namespace {
+// Lee el siguiente "..." de line desde pos; raw queda sin las comillas y todavía escapado
+bool ReadJournalString(std::string_view line, size_t& pos, std::string_view& raw) {
+    while (pos < line.size() && line[pos] == ' ') pos++;
+    if (pos >= line.size() || line[pos] != '"') return false;
+
+    size_t start = ++pos;
+    while (pos < line.size() && line[pos] != '"') {
+        pos += (line[pos] == '\\') ? 2 : 1;
+    }
+    if (pos >= line.size()) return false;
+
+    raw = line.substr(start, pos - start);
+    pos++;
+    return true;
+}
+
+bool ParseJournalHeader(std::string_view line, JournalRun& run) {
+    std::string_view fields[4];
+    line.remove_prefix(4);  // "run "
+    for (auto& field : fields) {
+        size_t separator = line.find(' ');
+        field = line.substr(0, separator);
+        line = (separator == std::string_view::npos) ? std::string_view() : line.substr(separator + 1);
+    }
+    if (!line.empty() || fields[1].empty()) return false;
+
+    auto parseField = [](std::string_view field, uint64_t& result, int base) {
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), result, base);
+        return error == std::errc() && end == field.data() + field.size();
+    };
+    run.timestamp = std::string(fields[1]);
+    return parseField(fields[0], run.id, 10) && parseField(fields[2], run.fromHash, 16) &&
+           parseField(fields[3], run.toHash, 16);
+}
+
+bool ParseJournalOp(std::string_view line, NameTable& names, JournalOp& op) {
+    op.removePlugin = (line[0] == '-');
+    size_t keyEnd = line.find(' ', 2);
+    if (line.size() < 3 || line[1] != ' ' || keyEnd == std::string_view::npos) return false;
+
+    const auto& keyList = GetRuleKeyList();
+    auto key = std::find(keyList.begin(), keyList.end(), line.substr(2, keyEnd - 2));
+    if (key == keyList.end()) return false;
+    op.keyIndex = static_cast<uint8_t>(key - keyList.begin());
+
+    size_t pos = keyEnd;
+    std::string_view raw;
+    if (!ReadJournalString(line, pos, raw)) return false;
+    op.plugin = InternJsonString(raw, names);
+
+    while (ReadJournalString(line, pos, raw)) {
+        op.presets.push_back(InternJsonString(raw, names));
+    }
+    while (pos < line.size() && line[pos] == ' ') pos++;
+    return pos == line.size() && (!op.removePlugin || op.presets.empty());
+}
+
+// Id de la última ejecución completa, buscando la última línea "end" desde el final del archivo
+uint64_t LastJournalRunId(std::ifstream& file) {
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    std::string tail;
+
+    for (std::streamoff window = 4096;; window *= 4) {
+        std::streamoff start = std::max<std::streamoff>(0, size - window);
+        tail.resize(static_cast<size_t>(size - start));
+        file.seekg(start);
+        file.read(tail.data(), static_cast<std::streamsize>(tail.size()));
+        if (!file) return 0;
+
+        // Una línea sin '\n' al final del archivo quedó a medias: no cuenta
+        size_t lineEnd = tail.rfind('\n');
+        while (lineEnd != std::string::npos && lineEnd > 0) {
+            size_t newline = tail.rfind('\n', lineEnd - 1);
+            if (newline == std::string::npos && start > 0) break;  // Inicio de línea fuera de la ventana
+
+            size_t lineStart = (newline == std::string::npos) ? 0 : newline + 1;
+            std::string_view line = TrimView(std::string_view(tail).substr(lineStart, lineEnd - lineStart));
+            if (line.starts_with("end ")) {
+                uint64_t id = 0;
+                line.remove_prefix(4);
+                auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), id);
+                if (error == std::errc() && end == line.data() + line.size()) return id;
+            }
+            if (newline == std::string::npos) break;
+            lineEnd = newline;
+        }
+        if (start == 0) return 0;
+    }
+}
+}  // namespace
+
+bool AppendJournalRun(const fs::path& journalPath, JournalRun& run, const NameTable& names, AsyncLog& logFile) {
+    try {
+        bool needsNewline = false;
+        run.id = 1;
+        {
+            std::ifstream existing(journalPath, std::ios::binary);
+            if (existing.is_open()) {
+                run.id = LastJournalRunId(existing) + 1;
+                existing.clear();
+                existing.seekg(0, std::ios::end);
+                if (existing.tellg() > 0) {
+                    existing.seekg(-1, std::ios::end);
+                    needsNewline = (existing.get() != '\n');  // Cola de una escritura interrumpida
+                }
+            }
+        }
+        if (run.timestamp.empty()) {
+            run.timestamp = CurrentTimestamp();
+        }
+
+        const auto& keyList = GetRuleKeyList();
+        std::string record;
+        if (needsNewline) record += '\n';
+        record += "run " + std::to_string(run.id) + " " + run.timestamp + " " + FormatHash(run.fromHash) + " " +
+                  FormatHash(run.toHash) + "\n";
+        for (const JournalOp& op : run.ops) {
+            record += op.removePlugin ? "- " : "= ";
+            record += keyList[op.keyIndex];
+            record += " \"";
+            record += names.escaped(op.plugin);
+            record += '"';
+            for (NameId preset : op.presets) {
+                record += " \"";
+                record += names.escaped(preset);
+                record += '"';
+            }
+            record += '\n';
+        }
+        record += "end " + std::to_string(run.id) + "\n";
+
+        fs::create_directories(journalPath.parent_path());
+        std::ofstream journal(journalPath, std::ios::out | std::ios::app | std::ios::binary);
+        if (!journal.is_open()) {
+            logFile.error() << "ERROR: Could not open operation journal: " << journalPath.string() << std::endl;
+            return false;
+        }
+        journal.write(record.data(), static_cast<std::streamsize>(record.size()));
+        journal.close();
+        if (journal.fail()) {
+            logFile.error() << "ERROR: Could not write operation journal: " << journalPath.string() << std::endl;
+            return false;
+        }
+
+        logFile << "Operation journal: run #" << run.id << " recorded (" << run.ops.size() << " operations, "
+                << FormatHash(run.fromHash) << " -> " << FormatHash(run.toHash) << ")" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in AppendJournalRun: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool LoadOperationJournal(const fs::path& journalPath, NameTable& names, std::vector<JournalRun>& runs) {
+    runs.clear();
+    try {
+        std::ifstream journal(journalPath, std::ios::binary);
+        if (!journal.is_open()) return false;
+        std::string content((std::istreambuf_iterator<char>(journal)), std::istreambuf_iterator<char>());
+
+        JournalRun current;
+        bool open = false;
+        size_t pos = 0;
+        while (pos < content.size()) {
+            size_t lineEnd = content.find('\n', pos);
+            if (lineEnd == std::string::npos) break;  // Última línea a medias
+            std::string_view line = TrimView(std::string_view(content).substr(pos, lineEnd - pos));
+            pos = lineEnd + 1;
+            if (line.empty()) continue;
+
+            if (line.starts_with("run ")) {
+                // Una ejecución sin "end" seguida de otra es una escritura interrumpida: se descarta
+                current = JournalRun();
+                open = ParseJournalHeader(line, current);
+            } else if (!open) {
+                continue;
+            } else if (line.starts_with("end ")) {
+                if (line.substr(4) == std::to_string(current.id)) {
+                    runs.push_back(std::move(current));
+                }
+                current = JournalRun();
+                open = false;
+            } else if (line[0] == '=' || line[0] == '-') {
+                JournalOp op;
+                if (ParseJournalOp(line, names, op)) {
+                    current.ops.push_back(std::move(op));
+                } else {
+                    open = false;  // Una operación ilegible invalida la ejecución entera
+                }
+            } else {
+                open = false;
+            }
+        }
+        return true;
+    } catch (...) {
+        runs.clear();
+        return false;
+    }
+}
+
+void ApplyJournalOps(const std::vector<JournalOp>& ops, std::map<std::string, OrderedPluginData>& processedData) {
+    std::vector<OrderedPluginData*> keyData = ResolveRuleKeyData(processedData);
+
+    for (const JournalOp& op : ops) {
+        if (op.keyIndex >= keyData.size()) continue;
+        OrderedPluginData& data = *keyData[op.keyIndex];
+        if (op.removePlugin) {
+            data.removePlugin(op.plugin);
+        } else {
+            std::vector<NameId> presets = op.presets;
+            std::unordered_set<NameId> presetIndex(presets.begin(), presets.end());
+            data.assignPlugin(op.plugin, std::move(presets), std::move(presetIndex));
+        }
+    }
+
+    for (auto& [key, data] : processedData) {
+        RefreshSectionHash(data);
+    }
+}
+
+bool ReplayOperationJournal(std::string_view baseContent, const std::vector<JournalRun>& runs, uint64_t targetHash,
+                            NameTable& names, std::string& result, std::string& error) {
+    try {
+        uint64_t baseHash = HashBytes(baseContent);
+        if (baseHash == targetHash) {
+            result = std::string(baseContent);
+            return true;
+        }
+
+        // Cadena de ejecuciones hacia atrás desde la más reciente que produjo targetHash. Cada paso busca
+        // sólo entre ejecuciones anteriores, así que un estado repetido no puede formar un ciclo.
+        std::vector<const JournalRun*> chain;
+        uint64_t wanted = targetHash;
+        size_t limit = runs.size();
+        while (true) {
+            const JournalRun* step = nullptr;
+            while (limit > 0) {
+                if (runs[--limit].toHash == wanted) {
+                    step = &runs[limit];
+                    break;
+                }
+            }
+            if (step == nullptr) {
+                error = "No journal runs lead from this base to " + FormatHash(targetHash);
+                return false;
+            }
+            chain.push_back(step);
+            if (step->fromHash == baseHash) break;
+            wanted = step->fromHash;
+        }
+        std::reverse(chain.begin(), chain.end());
+
+        JsonValidationResult validation = ValidateJson(baseContent);
+        if (!validation.valid) {
+            error = "Base JSON is not valid: " + validation.error;
+            return false;
+        }
+
+        std::string current(baseContent);
+        JsonSectionIndex sectionIndex = std::move(validation.sections);
+        std::map<std::string, OrderedPluginData> processedData;
+        LoadSectionsFromJson(current, sectionIndex, processedData, names);
+
+        AsyncLog noLog;
+        for (const JournalRun* step : chain) {
+            ApplyJournalOps(step->ops, processedData);
+            std::string next =
+                PreserveOriginalSections(current, sectionIndex, SerializeSections(processedData, names), noLog);
+
+            // La ejecución original pudo terminar con el reformateo de indentación
+            if (HashBytes(next) != step->toHash) {
+                std::string formatted = FormatJsonCanonical(next);
+                if (HashBytes(formatted) != step->toHash) {
+                    error = "Replaying run #" + std::to_string(step->id) + " does not reproduce " +
+                            FormatHash(step->toHash);
+                    return false;
+                }
+                next = std::move(formatted);
+            }
+
+            // El resultado es el JSON de partida del siguiente paso, como si se hubiera vuelto a leer
+            current = std::move(next);
+            sectionIndex = IndexTopLevelSections(current);
+            for (auto& [key, data] : processedData) {
+                data.sourceHash = data.contentHash;
+            }
+        }
+
+        result = std::move(current);
+        return true;
+    } catch (const std::exception& e) {
+        error = std::string("Replay failed: ") + e.what();
+        return false;
+    }
+}
+
+bool RebuildJournalState(const fs::path& pluginsPath, const std::vector<JournalRun>& runs, const JournalRun& run,
+                         bool beforeRun, NameTable& names, std::string& result, std::string& source,
+                         std::string& error) {
+    try {
+        uint64_t targetHash = beforeRun ? run.fromHash : run.toHash;
+
+        std::vector<std::pair<std::string, std::string>> bases;  // (descripción, contenido)
+        BackupStore store;
+        store.root = pluginsPath / "Backup_OBody_DPA" / "Store";
+        BackupStoreManifest manifest;
+        if (LoadBackupStoreManifest(store, manifest)) {
+            for (auto entry = manifest.entries.rbegin(); entry != manifest.entries.rend(); ++entry) {
+                std::string content;
+                if (entry->kind == "backup" && LoadBackupSnapshot(store, *entry, content)) {
+                    bases.emplace_back("backup store version #" + std::to_string(entry->sequence),
+                                       std::move(content));
+                }
+            }
+        }
+        const std::pair<std::string, fs::path> files[] = {
+            {"literal backup", pluginsPath / "Backup_OBody_DPA" / "OBody_presetDistributionConfig.json"},
+            {"current JSON", pluginsPath / "OBody_presetDistributionConfig.json"}};
+        for (const auto& [label, path] : files) {
+            std::ifstream file(path, std::ios::binary);
+            if (file.is_open()) {
+                bases.emplace_back(label, std::string(std::istreambuf_iterator<char>(file), {}));
+            }
+        }
+
+        error = "no backup to start from";
+        for (auto& [label, content] : bases) {
+            if (ReplayOperationJournal(content, runs, targetHash, names, result, error)) {
+                source = std::move(label);
+                return true;
+            }
+        }
+        return false;
+    } catch (const std::exception& e) {
+        error = std::string("Rebuild failed: ") + e.what();
+        return false;
+    }
+}
+
+// ===== INFORME DE EJECUCIÓN =====
+
+size_t RunReport::stageIndex(std::string_view name) {
+    for (size_t i = 0; i < stages.size(); i++) {
+        if (stages[i].name == name) return i;
+    }
+    stages.push_back({std::string(name)});
+    return stages.size() - 1;
+}
+
+ScopedStageTimer::ScopedStageTimer(RunReport* report, std::string_view stage)
+    : report(report), start(std::chrono::steady_clock::now()) {
+    if (report != nullptr) {
+        index = report->stageIndex(stage);
+        report->stages[index].calls++;
+
+        if (AllocationTrackingEnabled()) {
+            trackingMemory = true;
+            startCounters = ReadAllocationCounters();
+            outerPeak = ResetPeakLiveBytes();
+        }
+    }
+}
+
+ScopedStageTimer::~ScopedStageTimer() { stop(); }
+
+void ScopedStageTimer::stop() {
+    if (report == nullptr) return;
+
+    StageReport& stage = report->stages[index];
+    stage.milliseconds += milliseconds();
+
+    if (trackingMemory) {
+        AllocationCounters counters = ReadAllocationCounters();
+        int64_t peak = PeakLiveBytes();
+        stage.allocations += counters.allocations - startCounters.allocations;
+        stage.bytesAllocated += counters.bytesAllocated - startCounters.bytesAllocated;
+        stage.peakLiveBytes = std::max(stage.peakLiveBytes, peak);
+        report->memoryTracked = true;
+        report->peakLiveBytes = std::max(report->peakLiveBytes, peak);
+        RaisePeakLiveBytes(outerPeak);
+    }
+    report = nullptr;
+}
+
+double ScopedStageTimer::milliseconds() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ScopedStageTimer::addRead(uint64_t bytes) {
+    if (report != nullptr) report->stages[index].bytesRead += bytes;
+}
+
+void ScopedStageTimer::addWritten(uint64_t bytes) {
+    if (report != nullptr) report->stages[index].bytesWritten += bytes;
+}
+
+std::string FormatRunReport(const RunReport& report) {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+
+    json << "{\"version\":1,\"timestamp\":\"" << report.timestamp << "\",\"outcome\":\"" << report.outcome
+         << "\",\"totalMs\":" << report.totalMilliseconds;
+    json << ",\"rules\":{\"files\":" << report.rules.filesProcessed << ",\"processed\":" << report.rules.rulesProcessed
+         << ",\"applied\":" << report.rules.rulesApplied << ",\"skipped\":" << report.rules.rulesSkipped
+         << ",\"presetsRemoved\":" << report.rules.presetsRemoved
+         << ",\"pluginsRemoved\":" << report.rules.pluginsRemoved << "}";
+    if (report.memoryTracked) {
+        json << ",\"memory\":{\"peakLiveBytes\":" << report.peakLiveBytes << "}";
+    }
+
+    json << ",\"stages\":[";
+    for (size_t i = 0; i < report.stages.size(); i++) {
+        const StageReport& stage = report.stages[i];
+        json << (i > 0 ? "," : "") << "{\"name\":\"" << EscapeJson(stage.name) << "\",\"ms\":" << stage.milliseconds
+             << ",\"calls\":" << stage.calls << ",\"bytesRead\":" << stage.bytesRead
+             << ",\"bytesWritten\":" << stage.bytesWritten;
+        if (report.memoryTracked) {
+            json << ",\"allocations\":" << stage.allocations << ",\"bytesAllocated\":" << stage.bytesAllocated
+                 << ",\"peakLiveBytes\":" << stage.peakLiveBytes;
+        }
+        json << "}";
+    }
+
+    json << "],\"files\":[";
+    for (size_t i = 0; i < report.files.size(); i++) {
+        const RuleFileReport& file = report.files[i];
+        json << (i > 0 ? "," : "") << "{\"file\":\"" << EscapeJson(file.file) << "\",\"applyMs\":"
+             << file.applyMilliseconds << ",\"writeBackMs\":" << file.writeBackMilliseconds
+             << ",\"bytesRead\":" << file.bytesRead << ",\"bytesWritten\":" << file.bytesWritten
+             << ",\"rules\":" << file.rulesProcessed << ",\"applied\":" << file.rulesApplied << "}";
+    }
+    json << "]}\n";
+    return json.str();
+}
+
+fs::path RunReportPath(const fs::path& logFilePath) {
+    fs::path reportPath = logFilePath;
+    reportPath.replace_extension(".report.json");
+    return reportPath;
+}
+
+bool WriteRunReport(const fs::path& reportPath, const RunReport& report, AsyncLog& logFile) {
+    try {
+        std::string content = FormatRunReport(report);
+        uint64_t checksum = 0;
+        if (!WriteFileWithChecksum(reportPath, content, checksum)) {
+            logFile.error() << "ERROR: Could not write run report: " << reportPath.string() << std::endl;
+            return false;
+        }
+        logFile << "Run report written to: " << reportPath.string() << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile.error() << "ERROR in WriteRunReport: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// ===== FUNCIÓN PRINCIPAL CORREGIDA CON CORRECCIÓN DE INDENTACIÓN =====
+// Sólo hace E/S de archivos (ninguna API del juego): la usan el plugin (también fuera del hilo
+// principal), la CLI y el benchmark. Devuelve el mensaje que debe mostrarse en la consola del juego.
+
+DistributionResult RunPresetDistribution(const DistributionPaths& paths) {
+    try {
+        // Configuración de rutas y logging
+        const fs::path& dataPath = paths.dataPath;
+        fs::path sksePluginsPath = dataPath / "SKSE" / "Plugins";
+        fs::path backupConfigIniPath = sksePluginsPath / "OBody_NG_Preset_Distribution_Assistant_NG.ini";
+
+        // Contabilidad de memoria opcional: se activa antes de la primera etapa para que todas la midan
+        bool trackMemory =
+            ParseOnceOrAlwaysValue(ReadIniValue(backupConfigIniPath, "Run report", "TrackMemory", "0"), 0) != 0;
+        SetAllocationTracking(trackMemory);
+
+        // Informe de tiempos de la ejecución, junto al log
+        RunReport report;
+        report.timestamp = CurrentTimestamp();
+        auto runStart = std::chrono::steady_clock::now();
+        ScopedStageTimer pathTimer(&report, "path resolution");
+
+        CreateDirectoryIfNotExists(sksePluginsPath);
+
+        CreateDirectoryIfNotExists(paths.logFilePath.parent_path());
+
+        AsyncLog logFile(paths.logFilePath);
+
+        auto now = std::chrono::system_clock::now();
+        std::time_t in_time_t = std::chrono::system_clock::to_time_t(now);
+        std::tm buf = SafeLocalTime(in_time_t);
+
+        logFile << "====================================================" << std::endl;
+        logFile << "OBody NG Preset Distribution Assistant NG - ULTRA SECURE VERSION WITH INLINE EMPTY "
+                   "CONTAINERS AND MULTI-LINE EMPTY DETECTION"
+                << std::endl;
+        logFile << "Log created on: " << std::put_time(&buf, "%Y-%m-%d %H:%M:%S") << std::endl;
+        logFile << "====================================================" << std::endl << std::endl;
+
+        // RUTAS PRINCIPALES (MODIFICADAS)
+        fs::path jsonOutputPath = sksePluginsPath / "OBody_presetDistributionConfig.json";
+        fs::path backupJsonPath =
+            sksePluginsPath / "Backup_OBody_DPA" / "OBody_presetDistributionConfig.json";
+        // Versiones de backup y copias de análisis deduplicadas por contenido (ver [Backup store] en el INI)
+        BackupStore backupStore =
+            ReadBackupStoreSettings(backupConfigIniPath, sksePluginsPath / "Backup_OBody_DPA" / "Store");
+        fs::path journalPath = sksePluginsPath / "Backup_OBody_DPA" / "OperationJournal.log";
+
+        logFile << "Checking backup configuration..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+        int backupValue = ReadBackupConfigFromIni(backupConfigIniPath, logFile);
+
+        // Nivel del log: sin la clave (INI anteriores) se mantiene el log completo, con una línea por regla
+        logFile.setLevel(
+            ParseLogLevel(ReadIniValue(backupConfigIniPath, "Logging", "Level", "detail"), LogLevel::RuleDetail));
+        logFile << "Log level: " << LogLevelName(logFile.getLevel()) << std::endl;
+        if (trackMemory && !AllocationTrackingEnabled()) {
+            logFile.error() << "WARNING: TrackMemory = 1 needs a build with PDA_TRACK_ALLOCATIONS, memory is "
+                               "not tracked"
+                            << std::endl;
+        }
+
+        fs::path reportPath = RunReportPath(paths.logFilePath);
+        auto finishReport = [&](const char* outcome) {
+            report.outcome = outcome;
+            report.totalMilliseconds =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+            SetAllocationTracking(false);
+            WriteRunReport(reportPath, report, logFile);
+        };
+
+        // ===== CACHÉ INCREMENTAL: SI NINGUNA ENTRADA CAMBIÓ, NO HAY NADA QUE HACER =====
+        fs::path runCacheManifestPath = sksePluginsPath / "OBody_NG_Preset_Distribution_Assistant_NG.cache";
+        int forceRunValue =
+            ParseOnceOrAlwaysValue(ReadIniValue(backupConfigIniPath, "Run cache", "ForceRun", "0"), 0);
+
+        // Reparación de formato: sin la clave (INI anteriores) se repara una vez para dejar el JSON canónico
+        int repairValue = ParseOnceOrAlwaysValue(ReadIniValue(backupConfigIniPath, "Formatting", "Repair", "1"), 0);
+        pathTimer.stop();
+
+        std::vector<fs::path> ruleFilePaths;
+        {
+            ScopedStageTimer timer(&report, "directory scan");
+            ruleFilePaths = CollectRuleFilePaths(dataPath, logFile);
+        }
+
+        ScopedStageTimer cacheTimer(&report, "run cache check");
+        logFile << std::endl;
+        logFile << "Checking run cache..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+        if (forceRunValue == 2) {
+            logFile << "Run cache disabled (ForceRun = true), performing full run" << std::endl;
+        } else if (forceRunValue == 1) {
+            logFile << "ForceRun = 1, performing full run (setting reset to 0)" << std::endl;
+            WriteIniValue(backupConfigIniPath, "Run cache", "ForceRun", "0");
+        } else if (backupValue != 0) {
+            logFile << "Backup requested, performing full run" << std::endl;
+        } else if (repairValue == 1) {
+            logFile << "Formatting repair requested, performing full run" << std::endl;
+        } else if (IsRunCacheValid(runCacheManifestPath, jsonOutputPath, ruleFilePaths, logFile)) {
+            logFile << "Run cache: JSON and all " << ruleFilePaths.size()
+                    << " OBodyNG_PDA_*.ini files are unchanged since the last run." << std::endl;
+            logFile << "Nothing to apply - skipping validation, rule processing and JSON update."
+                    << std::endl;
+            cacheTimer.stop();
+            finishReport("cached");
+            logFile << "====================================================" << std::endl;
+            logFile.close();
+
+            return {true, "OBody Assistant: No changes since last run (cached)."};
+        }
+
+        // A partir de aquí el JSON o los INI pueden cambiar: el manifiesto anterior deja de ser válido
+        InvalidateRunCache(runCacheManifestPath);
+        cacheTimer.stop();
+        bool runSucceeded = false;
+        WrittenContent finalOutput;  // Lo que queda en disco al final, para registrarlo en la caché
+        std::string updatedJsonContent;
+
+        // ===== PIPELINE DE LECTURA ÚNICA: el JSON se carga una vez y el mismo buffer pasa por
+        // validación, parseo, comparación, serialización y verificación posterior =====
+        std::string jsonContent;
+        {
+            ScopedStageTimer timer(&report, "load JSON");
+            LoadJsonFile(jsonOutputPath, jsonContent, logFile);
+            timer.addRead(jsonContent.size());
+        }
+
+        // Todas las restauraciones desde backup cuentan como una misma etapa
+        auto restoreFromBackup = [&] {
+            ScopedStageTimer timer(&report, "restore");
+            bool restored = RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, backupStore, jsonContent, logFile);
+            if (restored) {
+                timer.addWritten(jsonContent.size());
+            }
+            return restored;
+        };
+
+        // ===== VALIDACIÓN DE INTEGRIDAD INICIAL CON RESTAURACIÓN AUTOMÁTICA (MODIFICADO) =====
+        logFile << std::endl;
+        bool integrityPassed;
+        {
+            ScopedStageTimer timer(&report, "integrity check");
+            integrityPassed = PerformSimpleJsonIntegrityCheck(jsonOutputPath, jsonContent, logFile);
+        }
+        if (!integrityPassed) {
+            logFile << std::endl;
+            logFile.error() << "CRITICAL: JSON failed simple integrity check at startup! Attempting to restore "
+                               "from backup..."
+                            << std::endl;
+
+            // Intentar restaurar desde el backup
+            if (restoreFromBackup()) {
+                logFile << "SUCCESS: JSON restored from backup. Proceeding with the normal process."
+                        << std::endl;
+                // El proceso puede continuar normalmente después de la restauración.
+            } else {
+                // La restauración falló o no se encontró un backup. Ahora terminamos.
+                logFile << std::endl;
+                logFile.error() << "CRITICAL ERROR: Could not restore from backup. The JSON file is likely "
+                                   "corrupted and no valid backup is available."
+                                << std::endl;
+                logFile << "Process terminated to prevent further damage." << std::endl;
+                logFile << std::endl;
+                logFile << "RECOMMENDED ACTIONS:" << std::endl;
+                logFile << "1. Check the backup store for the corrupted file (manifest.ini lists every version): "
+                        << backupStore.root.string() << std::endl;
+                logFile << "2. Manually check for any older backups or reinstall the mod providing the "
+                           "base JSON file."
+                        << std::endl;
+                logFile << "3. Contact the mod author if the problem persists." << std::endl;
+                finishReport("failed");
+                logFile << "====================================================" << std::endl;
+                logFile.close();
+
+                return {false,
+                        "CRITICAL ERROR: OBody JSON is corrupted and could not be restored! Check the log file "
+                        "for details."};  // TERMINACIÓN TEMPRANA DEL PROCESO
+            }
+        }
+
+        // Si llegamos aquí, el JSON pasó la validación simple o fue restaurado exitosamente
+        logFile << "JSON passed initial integrity check or was restored - proceeding with normal process..."
+                << std::endl;
+        logFile << "JSON will be formatted with proper 4-space indentation hierarchy with inline empty "
+                   "containers and multi-line empty detection."
+                << std::endl;
+        logFile << std::endl;
+
+        // Inicializar estructuras de datos
+        const RuleKeySet& validKeys = GetValidRuleKeys();
+
+        std::map<std::string, OrderedPluginData> processedData;
+        for (const auto& key : validKeys) {
+            processedData[key] = OrderedPluginData();
+        }
+
+        // Tabla de nombres de esta ejecución: secciones, reglas y serialización trabajan con sus ids
+        NameTable names;
+
+        bool backupPerformed = false;
+
+        // SISTEMA DE BACKUP LITERAL PERFECTO
+        if (backupValue == 1 || backupValue == 2) {
+            if (backupValue == 2) {
+                logFile << "Backup enabled (Backup = true), performing LITERAL backup always..."
+                        << std::endl;
+            } else {
+                logFile << "Backup enabled (Backup = 1), performing LITERAL backup..." << std::endl;
+            }
+
+            ScopedStageTimer timer(&report, "backup");
+            if (PerformLiteralJsonBackup(jsonOutputPath, backupJsonPath, jsonContent, backupStore, logFile)) {
+                backupPerformed = true;
+                timer.addRead(jsonContent.size());
+                timer.addWritten(jsonContent.size());
+                // Solo actualizar INI si no es modo "true" (valor 2)
+                if (backupValue != 2) {
+                    UpdateBackupConfigInIni(backupConfigIniPath, logFile, backupValue);
+                }
+            } else {
+                logFile.error() << "ERROR: LITERAL backup failed, continuing with normal process..." << std::endl;
+            }
+
+        } else {
+            logFile << "Backup disabled (Backup = 0), skipping backup" << std::endl;
+            logFile
+                << "The original backup was already performed at "
+                   "\\SKSE\\Plugins\\Backup_OBody_DPA\\OBody_presetDistributionConfig.json"  // MODIFICADO
+                << std::endl;
+        }
+
+        logFile << std::endl;
+
+        // Leer el JSON existente con verificación mejorada; el índice de secciones se reutiliza al escribir
+        JsonSectionIndex sectionIndex;
+        auto readCompleteJson = [&] {
+            ScopedStageTimer timer(&report, "ReadCompleteJson");
+            return ReadCompleteJson(jsonOutputPath, jsonContent, processedData, names, sectionIndex, logFile);
+        };
+        bool readSuccess = readCompleteJson();
+
+        if (!readSuccess) {
+            logFile.error() << "JSON read failed, attempting to restore from backup..." << std::endl;
+            if (restoreFromBackup()) {
+                logFile << "Backup restoration successful, retrying JSON read..." << std::endl;
+                readSuccess = readCompleteJson();
+            }
+
+            if (!readSuccess) {
+                logFile.error()
+                    << "Process truncated due to JSON read error. No INI processing or updates performed."
+                    << std::endl;
+                finishReport("failed");
+                logFile << "====================================================" << std::endl;
+                logFile.close();
+
+                return {false, "ERROR: JSON READ FAILED - CONTACT MODDER OR REINSTALL!"};
+            } else {
+                logFile << "JSON read successful after restoration!" << std::endl;
+            }
+        }
+
+        RuleApplyStats ruleStats;
+        // Operaciones netas de esta ejecución para el diario, aplicadas sobre el JSON tal como se leyó
+        std::vector<JournalOp> journalOps;
+        uint64_t journalFromHash = HashBytes(jsonContent);
+
+        logFile << "Scanning for OBodyNG_PDA_*.ini files..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+
+        // Procesar archivos .ini: lectura y parseo en paralelo, aplicación en orden determinista
+        try {
+            std::vector<IniRuleFile> ruleFiles;
+            {
+                ScopedStageTimer timer(&report, "rule ingest");
+                ruleFiles = IngestRuleFilesParallel(ruleFilePaths, validKeys, names);
+                for (const auto& ruleFile : ruleFiles) {
+                    timer.addRead(ruleFile.content.size());
+                }
+            }
+            ApplyRuleFiles(ruleFiles, processedData, names, ruleStats, true, logFile, &journalOps, &report);
+        } catch (const std::exception& e) {
+            logFile.error() << "ERROR scanning directory: " << e.what() << std::endl;
+        }
+
+        logFile << std::endl;
+        logFile << "====================================================" << std::endl;
+        logFile << "SUMMARY:" << std::endl;
+
+        if (backupPerformed) {
+            try {
+                auto backupSize = fs::file_size(backupJsonPath);
+                logFile << "Original JSON backup: SUCCESS (" << backupSize << " bytes)" << std::endl;
+            } catch (...) {
+                logFile << "Original JSON backup: SUCCESS (size verification failed)" << std::endl;
+            }
+
+        } else {
+            logFile << "Original JSON backup: SKIPPED" << std::endl;
+        }
+
+        logFile << "Total .ini files processed: " << ruleStats.filesProcessed << std::endl;
+        logFile << "Total rules processed: " << ruleStats.rulesProcessed << std::endl;
+        logFile << "Total rules applied: " << ruleStats.rulesApplied << std::endl;
+        logFile << "Total rules skipped (count=0): " << ruleStats.rulesSkipped << std::endl;
+        logFile << "Total presets removed (-): " << ruleStats.presetsRemoved << std::endl;
+        logFile << "Total plugins removed (*): " << ruleStats.pluginsRemoved << std::endl;
+        logFile << std::endl << "Final data in JSON:" << std::endl;
+
+        for (const auto& [key, data] : processedData) {
+            size_t count = data.getTotalPresetCount();
+            if (count > 0) {
+                logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count
+                        << " total presets" << std::endl;
+            }
+        }
+
+        logFile << "====================================================" << std::endl << std::endl;
+
+        // ACTUALIZAR JSON CONSERVADORAMENTE CON FORMATO CORRECTO
+        logFile << "Updating JSON at: " << jsonOutputPath.string() << std::endl;
+        logFile << "Applying proper 4-space indentation format with inline empty containers and multi-line "
+                   "empty detection..."
+                << std::endl;
+
+        try {
+            // El contenido que queda en disco tras este paso (el recién escrito o el original)
+            const std::string* currentJsonContent = nullptr;
+
+            // 🔧 NUEVO: Verificar si los cambios de las reglas ya están aplicados en el JSON
+            bool changesNeeded;
+            {
+                ScopedStageTimer timer(&report, "diff");
+                changesNeeded = CheckIfChangesNeeded(processedData);
+            }
+            if (changesNeeded) {
+                logFile << "Changes from INI rules require updating the master JSON file. Proceeding with atomic write..." << std::endl;
+
+                // Sólo las secciones que cambiaron se serializan; el resto conserva sus bytes originales
+                {
+                    ScopedStageTimer timer(&report, "serialize");
+                    SerializedSections sections = SerializeSections(processedData, names);
+                    updatedJsonContent = PreserveOriginalSections(jsonContent, sectionIndex, sections, logFile);
+                }
+
+                // Si hay cambios, ejecutar escritura atómica
+                bool jsonWritten;
+                {
+                    ScopedStageTimer timer(&report, "write");
+                    jsonWritten =
+                        WriteJsonAtomically(jsonOutputPath, updatedJsonContent, backupStore, finalOutput, logFile);
+                    if (jsonWritten) {
+                        timer.addWritten(finalOutput.size);
+                    }
+                }
+                if (jsonWritten) {
+                    logFile << "SUCCESS: JSON updated successfully with proper 4-space indentation hierarchy!"
+                            << std::endl;
+                    currentJsonContent = &updatedJsonContent;
+                } else {
+                    logFile.error() << "ERROR: Failed to write JSON safely!" << std::endl;
+                    logFile << "Attempting to restore from backup due to write failure..." << std::endl;
+                    if (restoreFromBackup()) {
+                        logFile << "SUCCESS: JSON restored from backup after write failure!" << std::endl;
+                    } else {
+                        logFile.error() << "CRITICAL ERROR: Could not restore JSON from backup!" << std::endl;
+                    }
+                }
+            } else {
+                // Si no hay cambios, omitir escritura: el JSON en disco es el que se leyó
+                logFile << "No changes detected between INI rules and master JSON. Skipping redundant atomic write." << std::endl;
+                finalOutput = {jsonContent.size(), HashBytes(jsonContent), true};
+                currentJsonContent = &jsonContent;
+            }
+
+            // ===== REPARACIÓN OPCIONAL DE FORMATO =====
+            // Las secciones se escriben ya con el formato canónico (4 espacios, contenedores vacíos en línea),
+            // así que la pasada de reformateo sólo hace falta para JSON editados a mano o por otras herramientas
+            if (currentJsonContent != nullptr && repairValue == 0) {
+                logFile << "Formatting repair disabled ([Formatting] Repair = 0): JSON left as written." << std::endl;
+                runSucceeded = true;
+            } else if (currentJsonContent != nullptr) {
+                logFile << std::endl;
+                bool formatted;
+                {
+                    ScopedStageTimer timer(&report, "indentation check");
+                    uint64_t checksumBefore = finalOutput.checksum;
+                    formatted = CorrectJsonIndentation(jsonOutputPath, *currentJsonContent, backupStore, finalOutput,
+                                                       logFile);
+                    if (formatted && finalOutput.checksum != checksumBefore) {
+                        timer.addWritten(finalOutput.size);
+                    }
+                }
+                if (formatted) {
+                    logFile << "SUCCESS: JSON indentation verification and correction completed with "
+                               "inline empty containers and multi-line empty detection!"
+                            << std::endl;
+                    runSucceeded = true;
+                } else {
+                    logFile.error() << "ERROR: JSON indentation correction failed!" << std::endl;
+                    logFile << "Attempting to restore from backup due to indentation failure..." << std::endl;
+                    if (restoreFromBackup()) {
+                        logFile << "SUCCESS: JSON restored from backup after indentation failure!" << std::endl;
+                    } else {
+                        logFile.error() << "CRITICAL ERROR: Could not restore JSON from backup!" << std::endl;
+                    }
+                }
+            }
+
+        } catch (const std::exception& e) {
+            logFile.error() << "ERROR in JSON update process: " << e.what() << std::endl;
+            logFile << "Attempting to restore from backup due to update failure..." << std::endl;
+            if (restoreFromBackup()) {
+                logFile << "SUCCESS: JSON restored from backup after update failure!" << std::endl;
+            } else {
+                logFile.error() << "CRITICAL ERROR: Could not restore JSON from backup!" << std::endl;
+            }
+
+        } catch (...) {
+            logFile.error() << "ERROR in JSON update process: Unknown exception" << std::endl;
+            logFile << "Attempting to restore from backup due to unknown failure..." << std::endl;
+            if (restoreFromBackup()) {
+                logFile << "SUCCESS: JSON restored from backup after unknown failure!" << std::endl;
+            } else {
+                logFile.error() << "CRITICAL ERROR: Could not restore JSON from backup!" << std::endl;
+            }
+        }
+
+        // La reparación de una sola vez se desactiva sólo si la ejecución terminó bien
+        if (runSucceeded && repairValue == 1) {
+            WriteIniValue(backupConfigIniPath, "Formatting", "Repair", "0");
+            logFile << "Formatting repair completed (Repair reset to 0)" << std::endl;
+        }
+
+        // Anotar en el diario cómo se llegó al JSON final desde el leído, si cambió
+        if (runSucceeded && finalOutput.known && finalOutput.checksum != journalFromHash) {
+            JournalRun journalRun;
+            journalRun.fromHash = journalFromHash;
+            journalRun.toHash = finalOutput.checksum;
+            journalRun.ops = std::move(journalOps);
+            ScopedStageTimer timer(&report, "journal");
+            AppendJournalRun(journalPath, journalRun, names, logFile);
+        }
+
+        // Registrar las huellas del estado final para poder omitir la próxima ejecución
+        if (runSucceeded) {
+            ScopedStageTimer timer(&report, "run cache update");
+            if (RecordRunCache(runCacheManifestPath, jsonOutputPath, finalOutput, ruleFilePaths, logFile)) {
+                logFile << "Run cache updated: next launch will be skipped if nothing changes." << std::endl;
+            }
+        }
+
+        report.rules = ruleStats;
+        finishReport(runSucceeded ? "success" : "failed");
+
+        logFile << std::endl
+                << "Process completed successfully with perfect 4-space JSON formatting, inline empty "
+                   "containers, and multi-line empty detection."
+                << std::endl;
+        logFile.close();
+
+        return {runSucceeded, "OBody Assistant: Process completed successfully!"};
+
+    } catch (const std::exception& e) {
+        SetAllocationTracking(false);
+        return {false, "ERROR in OBody Assistant main process!"};
+    } catch (...) {
+        SetAllocationTracking(false);
+        return {false, "CRITICAL ERROR in OBody Assistant!"};
+    }
+}
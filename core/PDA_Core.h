@@ -0,0 +1,723 @@
+#pragma once
+
+// ===== NÚCLEO PORTABLE DEL ASISTENTE DE DISTRIBUCIÓN DE PRESETS =====
+// Motor de reglas, manejo del JSON, backups y caché de ejecución sin dependencias de Windows ni de
+// SKSE. Lo enlazan el plugin, la CLI y el benchmark (tools/).
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "core/PDA_Log.h"
+#include "core/PDA_Memory.h"
+
+namespace fs = std::filesystem;
+
+// ===== ESTRUCTURAS DE REGLAS Y DATOS =====
+
+// Los campos son vistas sobre el texto de la línea: sólo son válidos mientras viva ese buffer
+struct ParsedRule {
+    std::string_view key;
+    std::string_view plugin;
+    std::vector<std::string_view> presets;
+    std::string_view extra;
+    int applyCount = -1;
+};
+
+// Claves de regla con búsqueda heterogénea (admite std::string_view sin construir un std::string)
+using RuleKeySet = std::set<std::string, std::less<>>;
+
+// ===== TABLA DE NOMBRES INTERNADOS =====
+// Cada nombre distinto de plugin o preset de una ejecución se guarda una sola vez en un arena y se
+// identifica por un NameId estable: los datos de las secciones y las reglas trabajan con ids, y las
+// comparaciones son comparaciones de enteros. Los nombres se guardan sin escapar (tal como los ve el
+// juego); la forma escapada para el JSON se calcula una sola vez por id. No es segura entre hilos: se
+// usa desde el hilo que ejecuta el pipeline.
+
+using NameId = uint32_t;
+constexpr NameId kInvalidName = UINT32_MAX;
+
+struct NameTable {
+    NameId intern(std::string_view name);
+    NameId find(std::string_view name) const;
+
+    std::string_view name(NameId id) const { return entries[id].text; }
+
+    // Id del mismo nombre sin el prefijo '!' (el propio id si no lo tiene)
+    NameId stripped(NameId id) const { return entries[id].stripped; }
+
+    // Id de "!" + nombre si ya se internó, kInvalidName si no
+    NameId bang(NameId id) const { return entries[id].bang; }
+
+    const std::string& escaped(NameId id) const;
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        std::string_view text;
+        NameId stripped = kInvalidName;
+        NameId bang = kInvalidName;
+    };
+
+    std::string_view store(std::string_view name);
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* currentBlock = nullptr;
+    size_t blockUsed = 0;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string_view, NameId> lookup;
+    mutable std::vector<std::string> escapedCache;
+    mutable std::vector<bool> escapedReady;
+};
+
+// ===== CONTENEDOR ORDENADO CON ÍNDICES HASH =====
+// Conserva el orden de inserción de los plugins (el mismo orden de salida de siempre) y resuelve las
+// búsquedas de plugin y preset por hash de sus NameId. Los plugins eliminados dejan un hueco que se
+// compacta en bloque, así que borrar no desplaza el vector en cada operación. Los contadores se
+// mantienen al día.
+//
+// Cada sección guarda además el hash canónico (sobre NameId, sólo comparable dentro de la misma
+// ejecución) de cómo se leyó del JSON y de su contenido actual. Toda modificación marca la sección
+// como sucia; RefreshSectionHash recalcula sólo las secciones sucias.
+
+// Hash FNV-1a de una secuencia vacía: el de una sección sin plugins
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+
+struct OrderedPluginData {
+    struct PluginEntry {
+        NameId plugin = kInvalidName;
+        std::vector<NameId> presets;
+        std::unordered_set<NameId> presetIndex;
+        bool removed = false;
+
+        // Devuelve true si el preset se añadió (false si ya existía)
+        bool addPreset(NameId preset) {
+            if (!presetIndex.insert(preset).second) {
+                return false;
+            }
+            presets.push_back(preset);
+            return true;
+        }
+
+        // Devuelve true si se eliminó un preset. La comparación ignora el prefijo '!' en ambos lados.
+        bool removePreset(NameId preset, const NameTable& names) {
+            NameId strippedTarget = names.stripped(preset);
+            NameId bangTarget = names.bang(strippedTarget);
+
+            // Sólo las formas "X" y "!X" pueden coincidir: si ninguna está indexada no hay nada que recorrer
+            if (!presetIndex.contains(strippedTarget) &&
+                (bangTarget == kInvalidName || !presetIndex.contains(bangTarget))) {
+                return false;
+            }
+
+            auto presetIt = std::find_if(presets.begin(), presets.end(), [&](NameId p) {
+                return names.stripped(p) == strippedTarget;
+            });
+            if (presetIt == presets.end()) {
+                return false;
+            }
+
+            presetIndex.erase(*presetIt);
+            presets.erase(presetIt);
+            return true;
+        }
+    };
+
+    class const_iterator {
+    public:
+        using value_type = std::pair<NameId, const std::vector<NameId>&>;
+
+        const_iterator(const PluginEntry* current, const PluginEntry* last) : current(current), last(last) {
+            skipRemoved();
+        }
+
+        value_type operator*() const { return {current->plugin, current->presets}; }
+
+        const_iterator& operator++() {
+            ++current;
+            skipRemoved();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return current == other.current; }
+        bool operator!=(const const_iterator& other) const { return current != other.current; }
+
+    private:
+        void skipRemoved() {
+            while (current != last && current->removed) ++current;
+        }
+
+        const PluginEntry* current;
+        const PluginEntry* last;
+    };
+
+    std::vector<PluginEntry> entries;
+    std::unordered_map<NameId, size_t> pluginIndex;
+    size_t pluginCount = 0;
+    size_t presetCount = 0;
+    size_t removedSlots = 0;
+    uint64_t sourceHash = kFnvOffsetBasis;   // Sección tal como se leyó del JSON
+    uint64_t contentHash = kFnvOffsetBasis;  // Contenido actual (válido cuando dirty == false)
+    bool dirty = false;
+
+    // Devuelve true si el preset se añadió (false si ya existía)
+    bool addPreset(NameId plugin, NameId preset) {
+        auto it = pluginIndex.find(plugin);
+        if (it == pluginIndex.end()) {
+            PluginEntry& entry = entries.emplace_back();
+            entry.plugin = plugin;
+            entry.presets.reserve(20);
+            entry.presets.push_back(preset);
+            entry.presetIndex.insert(preset);
+            pluginIndex.emplace(plugin, entries.size() - 1);
+            pluginCount++;
+            presetCount++;
+            dirty = true;
+            return true;
+        }
+
+        if (!entries[it->second].addPreset(preset)) {
+            return false;
+        }
+        presetCount++;
+        dirty = true;
+        return true;
+    }
+
+    // Devuelve true si se eliminó un preset. La comparación ignora el prefijo '!' en ambos lados.
+    bool removePreset(NameId plugin, NameId preset, const NameTable& names) {
+        auto it = pluginIndex.find(plugin);
+        if (it == pluginIndex.end()) {
+            return false;
+        }
+
+        PluginEntry& entry = entries[it->second];
+        if (!entry.removePreset(preset, names)) {
+            return false;
+        }
+
+        presetCount--;
+        dirty = true;
+        if (entry.presets.empty()) {
+            eraseEntry(it);
+        }
+        return true;
+    }
+
+    // Devuelve true si el plugin existía y se eliminó con todos sus presets
+    bool removePlugin(NameId plugin) {
+        auto it = pluginIndex.find(plugin);
+        if (it == pluginIndex.end()) {
+            return false;
+        }
+        presetCount -= entries[it->second].presets.size();
+        eraseEntry(it);
+        dirty = true;
+        return true;
+    }
+
+    bool hasPlugin(NameId plugin) const { return pluginIndex.contains(plugin); }
+
+    const PluginEntry* findPlugin(NameId plugin) const {
+        auto it = pluginIndex.find(plugin);
+        return it == pluginIndex.end() ? nullptr : &entries[it->second];
+    }
+
+    // Sustituye los presets de un plugin existente (conserva su posición) o lo añade al final
+    void assignPlugin(NameId plugin, std::vector<NameId>&& presets, std::unordered_set<NameId>&& presetIndexValues) {
+        auto it = pluginIndex.find(plugin);
+        if (it == pluginIndex.end()) {
+            PluginEntry& entry = entries.emplace_back();
+            entry.plugin = plugin;
+            it = pluginIndex.emplace(plugin, entries.size() - 1).first;
+            pluginCount++;
+        }
+
+        PluginEntry& entry = entries[it->second];
+        presetCount -= entry.presets.size();
+        entry.presets = std::move(presets);
+        entry.presetIndex = std::move(presetIndexValues);
+        presetCount += entry.presets.size();
+        dirty = true;
+    }
+
+    bool empty() const { return pluginCount == 0; }
+
+    size_t getPluginCount() const { return pluginCount; }
+
+    size_t getTotalPresetCount() const { return presetCount; }
+
+    const_iterator begin() const {
+        return const_iterator(entries.data(), entries.data() + entries.size());
+    }
+
+    const_iterator end() const {
+        return const_iterator(entries.data() + entries.size(), entries.data() + entries.size());
+    }
+
+private:
+    void eraseEntry(std::unordered_map<NameId, size_t>::iterator it) {
+        PluginEntry& entry = entries[it->second];
+        entry.removed = true;
+        entry.presets = {};
+        entry.presetIndex = {};
+        pluginIndex.erase(it);
+        pluginCount--;
+        removedSlots++;
+
+        // Compactar cuando los huecos superan a los plugins vivos (coste amortizado O(1) por borrado)
+        if (removedSlots > 32 && removedSlots > pluginCount) {
+            compact();
+        }
+    }
+
+    void compact() {
+        std::erase_if(entries, [](const PluginEntry& entry) { return entry.removed; });
+        pluginIndex.clear();
+        for (size_t i = 0; i < entries.size(); i++) {
+            pluginIndex.emplace(entries[i].plugin, i);
+        }
+        removedSlots = 0;
+    }
+};
+
+// Operación compilada de una línea de regla (sufijo -> tipo):
+//   x / vacío -> Add, 1 -> AddCounted, x- -> RemovePresets, - -> RemovePresetsOnce,
+//   x* -> RemovePlugin, * -> RemovePluginOnce, 0 -> Skip, cualquier otro -> SkipInvalid
+enum class RuleOpType : uint8_t {
+    Add,
+    AddCounted,
+    RemovePresets,
+    RemovePresetsOnce,
+    RemovePlugin,
+    RemovePluginOnce,
+    Skip,
+    SkipInvalid
+};
+
+struct RuleOp {
+    RuleOpType type = RuleOpType::Skip;
+    uint8_t keyIndex = 0;              // Índice en GetRuleKeyList()
+    int counterAfter = -1;             // Valor a escribir en el INI tras ejecutar (-1: no se reescribe)
+    size_t lineIndex = 0;              // Línea del archivo (base 0) donde se leyó la regla
+    NameId plugin = kInvalidName;
+    std::vector<NameId> presets;       // En las eliminaciones ya sin el prefijo '!'
+    std::string extra;                 // Sufijo original, sólo para el log
+};
+
+struct IniRuleLine {
+    size_t lineIndex = 0;  // Línea del archivo (base 0) donde se leyó la regla
+    ParsedRule rule;
+};
+
+struct IniRuleFile {
+    fs::path path;
+    std::string filename;
+    std::string content;            // Contenido binario tal como se leyó (se reutiliza al actualizar contadores)
+    std::vector<IniRuleLine> rules;  // Vistas sobre content, parseadas en los hilos de ingesta; se vacían al compilar
+    std::vector<RuleOp> ops;         // Compiladas en serie sobre la tabla de nombres de la ejecución
+    bool opened = false;
+};
+
+struct IniCountUpdate {
+    size_t lineIndex = 0;  // Línea del archivo (base 0) donde se leyó la regla
+    int newCount = 0;
+};
+
+struct RuleApplyStats {
+    int filesProcessed = 0;
+    int rulesProcessed = 0;
+    int rulesApplied = 0;
+    int rulesSkipped = 0;
+    int presetsRemoved = 0;
+    int pluginsRemoved = 0;
+};
+
+// Texto final ("{...}") de cada clave válida cuyo contenido cambió respecto al JSON leído; las secciones
+// sin cambios no se serializan y conservan sus bytes originales
+struct SerializedSections {
+    std::map<std::string, std::string> values;
+};
+
+// Posición de cada miembro del objeto raíz del JSON, registrada en una sola pasada. Las vistas apuntan
+// al texto indexado: el índice sólo es válido mientras ese buffer no cambie.
+struct JsonSectionSpan {
+    std::string_view key;  // Nombre tal como aparece entre comillas
+    size_t valueStart = 0;  // Primer byte del valor
+    size_t valueEnd = 0;    // Un byte después del final del valor
+};
+
+struct JsonSectionIndex {
+    std::vector<JsonSectionSpan> sections;  // En orden de aparición
+
+    // Primera aparición de la clave en el nivel superior, nullptr si no existe
+    const JsonSectionSpan* find(std::string_view key) const {
+        for (const auto& section : sections) {
+            if (section.key == key) return &section;
+        }
+        return nullptr;
+    }
+};
+
+// Resultado de la validación completa de la gramática JSON en una sola pasada. Las posiciones de error
+// son las del primer error encontrado; las secciones se registran mientras se valida, así que quien
+// valida no necesita volver a recorrer el texto para localizarlas (las vistas apuntan al texto validado).
+struct JsonValidationResult {
+    bool valid = false;
+    std::string error;             // Descripción del primer error (vacía si es válido)
+    size_t errorOffset = 0;        // Byte del primer error
+    size_t errorLine = 0;          // Línea del primer error (base 1)
+    size_t errorColumn = 0;        // Columna del primer error (base 1, en bytes)
+    size_t trailingCommas = 0;     // Comas justo antes de '}' o ']': se toleran con un aviso, como siempre
+    size_t firstTrailingComma = 0;  // Byte de la primera de ellas
+    JsonSectionIndex sections;     // Miembros del objeto raíz (sólo completo si valid)
+};
+
+struct FileFingerprint {
+    std::string name;
+    uintmax_t size = 0;
+    long long modified = 0;
+    uint64_t hash = 0;
+};
+
+// Contenido que una escritura verificada dejó en disco: el checksum (FNV-1a) se calcula mientras se
+// escribe, así que registrar la salida en la caché no obliga a releer el archivo
+struct WrittenContent {
+    uintmax_t size = 0;
+    uint64_t checksum = 0;
+    bool known = false;
+};
+
+struct RunCacheManifest {
+    FileFingerprint output;  // El JSON tal como quedó al terminar la ejecución
+    std::vector<FileFingerprint> ruleFiles;
+};
+
+// ===== ALMACÉN DE BACKUPS DIRECCIONADO POR CONTENIDO =====
+// Cada instantánea del JSON se guarda una sola vez en <root>/objects como un blob nombrado por el hash
+// de su contenido (comprimido si así se configura y si ocupa menos). Un manifiesto pequeño lista las
+// versiones de cada tipo ("backup", "corrupted", "rejected"): guardar un contenido que ya existe sólo
+// lo convierte en la versión más reciente y se conservan las últimas keepVersions versiones distintas
+// de cada tipo; sólo se borran los blobs de las versiones que descarta la retención. Un manifiesto que no
+// se puede leer se aparta como manifest.ini.bad sin tocar los blobs. Restaurar es una búsqueda en el
+// manifiesto seguida de la lectura de un blob.
+
+struct BackupStore {
+    fs::path root;             // Backup_OBody_DPA/Store
+    size_t keepVersions = 10;  // Versiones distintas que se conservan de cada tipo (mínimo 1)
+    bool compress = true;
+};
+
+struct BackupStoreEntry {
+    uint64_t sequence = 0;  // Orden de guardado: la versión más reciente tiene el mayor
+    std::string kind;
+    std::string timestamp;  // AAAAMMDD_HHMMSS
+    uint64_t hash = 0;      // FNV-1a del contenido: da nombre al blob
+    uintmax_t size = 0;     // Tamaño sin comprimir
+    bool compressed = false;
+};
+
+struct BackupStoreManifest {
+    uint64_t nextSequence = 1;
+    std::vector<BackupStoreEntry> entries;  // En orden de sequence
+};
+
+// ===== DIARIO DE OPERACIONES =====
+// Cada ejecución que cambia el JSON añade al diario (un archivo de texto que sólo crece) las operaciones
+// netas que aplicó a los datos: exactamente las llamadas que hizo RuleCoalescer::commit, en el mismo
+// orden. Con el hash del JSON de partida y del resultado de cada ejecución, el estado de cualquier
+// ejecución pasada se reconstruye repitiendo las operaciones sobre un backup, sin guardar copias.
+
+struct JournalOp {
+    bool removePlugin = false;    // true: se elimina el plugin; false: se fijan sus presets (al final si es nuevo)
+    uint8_t keyIndex = 0;         // Índice en GetRuleKeyList()
+    NameId plugin = kInvalidName;
+    std::vector<NameId> presets;  // Presets finales, en orden
+};
+
+struct JournalRun {
+    uint64_t id = 0;
+    std::string timestamp;  // AAAAMMDD_HHMMSS
+    uint64_t fromHash = 0;  // FNV-1a del JSON sobre el que se aplicaron las operaciones
+    uint64_t toHash = 0;    // FNV-1a del JSON que quedó en disco (incluido el reformateo, si lo hubo)
+    std::vector<JournalOp> ops;
+};
+
+// ===== INFORME DE EJECUCIÓN =====
+// Tiempos por etapa y por archivo de reglas, con los bytes leídos y escritos, para comparar ejecuciones
+// entre instalaciones. Se guarda como una línea JSON compacta junto al log en cada ejecución.
+
+struct StageReport {
+    std::string name;
+    double milliseconds = 0;
+    size_t calls = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    // Sólo con [Run report] TrackMemory: asignaciones de todos los hilos durante la etapa y el máximo de
+    // bytes vivos que se alcanzó en ella
+    uint64_t allocations = 0;
+    uint64_t bytesAllocated = 0;
+    int64_t peakLiveBytes = 0;
+};
+
+struct RuleFileReport {
+    std::string file;
+    double applyMilliseconds = 0;      // Sus reglas sobre el coalescedor
+    double writeBackMilliseconds = 0;  // Reescritura de contadores del INI
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    int rulesProcessed = 0;
+    int rulesApplied = 0;
+};
+
+struct RunReport {
+    std::string timestamp;  // AAAAMMDD_HHMMSS
+    std::string outcome;    // "success", "failed" o "cached"
+    double totalMilliseconds = 0;
+    std::vector<StageReport> stages;  // En el orden en que empezó cada una
+    std::vector<RuleFileReport> files;
+    RuleApplyStats rules;
+    bool memoryTracked = false;
+    int64_t peakLiveBytes = 0;  // De toda la ejecución, con memoryTracked
+
+    // Etapa por nombre; se añade al final la primera vez
+    size_t stageIndex(std::string_view name);
+};
+
+// Suma al informe el tiempo de su ámbito bajo el nombre de la etapa. Con report nulo no registra nada.
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(RunReport* report, std::string_view stage);
+    ~ScopedStageTimer();
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+    void addRead(uint64_t bytes);
+    void addWritten(uint64_t bytes);
+    double milliseconds() const;  // Desde el inicio del ámbito (también sin informe)
+    // Registra ya la etapa, para las que no coinciden con un ámbito; el destructor no vuelve a sumar
+    void stop();
+
+private:
+    RunReport* report;
+    size_t index = 0;
+    std::chrono::steady_clock::time_point start;
+    bool trackingMemory = false;
+    AllocationCounters startCounters;
+    int64_t outerPeak = 0;  // Pico de la etapa que contiene a esta, que se restaura al terminar
+};
+
+// ===== COALESCENCIA DE REGLAS POR (CLAVE, PLUGIN) =====
+// Las operaciones se simulan en orden sobre una copia local de cada plugin afectado, lo que da el
+// resultado exacto de cada regla para el log y los contadores. Al terminar sólo se vuelca a los datos
+// del JSON el estado neto de cada plugin: las altas y bajas que se cancelan nunca tocan OrderedPluginData.
+
+struct RuleCoalescer {
+    struct PluginState {
+        uint8_t keyIndex = 0;
+        NameId plugin = kInvalidName;
+        bool exists = false;
+        bool changed = false;
+        uint64_t createdAt = 0;           // Secuencia de la última creación en esta ejecución (0: ya existía)
+        OrderedPluginData::PluginEntry entry;
+    };
+
+    RuleCoalescer(std::map<std::string, OrderedPluginData>& processedData, const NameTable& names);
+
+    // Simula la operación y devuelve su resultado: presets añadidos/eliminados, o 1 si se eliminó el plugin
+    int apply(const RuleOp& op);
+
+    // Vuelca el estado neto de cada plugin modificado conservando el orden de inserción de siempre
+    void commit();
+
+    const NameTable& names;
+    std::vector<OrderedPluginData*> keyData;
+    std::vector<std::unordered_map<NameId, size_t>> stateIndex;
+    std::vector<PluginState> states;
+    uint64_t sequence = 0;
+    std::vector<JournalOp>* journal = nullptr;  // Si no es nulo, commit() registra aquí cada operación neta
+
+private:
+    PluginState& stateFor(const RuleOp& op);
+};
+
+// ===== UTILIDADES =====
+
+std::tm SafeLocalTime(std::time_t time);
+void CreateDirectoryIfNotExists(const fs::path& path);
+std::string_view TrimView(std::string_view str);
+bool NextToken(std::string_view& remaining, char delimiter, std::string_view& token);
+std::string Trim(std::string_view str);
+std::vector<std::string> Split(std::string_view str, char delimiter);
+std::string EscapeJson(std::string_view str);
+std::string UnescapeJson(std::string_view str);
+ParsedRule ParseRuleLine(std::string_view key, std::string_view value);
+const RuleKeySet& GetValidRuleKeys();
+
+// ===== AJUSTES INI =====
+
+int ReadBackupConfigFromIni(const fs::path& iniPath, AsyncLog& logFile);
+void UpdateBackupConfigInIni(const fs::path& iniPath, AsyncLog& logFile, int originalValue);
+std::string ReadIniValue(const fs::path& iniPath, const std::string& section, const std::string& key,
+                         const std::string& defaultValue);
+bool WriteIniValue(const fs::path& iniPath, const std::string& section, const std::string& key,
+                   const std::string& value);
+int ParseOnceOrAlwaysValue(const std::string& value, int defaultValue);
+
+// ===== JSON: LECTURA, VALIDACIÓN Y ESCRITURA =====
+
+bool LoadJsonFile(const fs::path& jsonPath, std::string& content, AsyncLog& logFile);
+bool PerformSimpleJsonIntegrityCheck(const fs::path& jsonPath, std::string_view content, AsyncLog& logFile);
+JsonValidationResult ValidateJson(std::string_view json);
+void LocateJsonOffset(std::string_view json, size_t offset, size_t& line, size_t& column);
+// Con sectionIndex se devuelve el índice de secciones construido durante la validación
+bool PerformTripleValidation(std::string_view content, AsyncLog& logFile,
+                             JsonSectionIndex* sectionIndex = nullptr);
+std::vector<std::pair<NameId, std::vector<NameId>>> parseOrderedPlugins(std::string_view content, NameTable& names);
+// Carga las 8 secciones válidas de un JSON ya validado e indexado, con sus hashes de origen
+void LoadSectionsFromJson(std::string_view json, const JsonSectionIndex& sectionIndex,
+                          std::map<std::string, OrderedPluginData>& processedData, NameTable& names);
+// jsonContent llega ya cargado con LoadJsonFile: se valida y se parsea sin volver a leer el archivo.
+// sectionIndex recibe las secciones de nivel superior de jsonContent tal como quedó tras la lectura.
+bool ReadCompleteJson(const fs::path& jsonPath, std::string& jsonContent,
+                      std::map<std::string, OrderedPluginData>& processedData, NameTable& names,
+                      JsonSectionIndex& sectionIndex, AsyncLog& logFile);
+uint64_t HashSectionEntries(const std::vector<std::pair<NameId, std::vector<NameId>>>& entries);
+uint64_t HashSectionEntries(const OrderedPluginData& data);
+void RefreshSectionHash(OrderedPluginData& data);
+bool SectionChanged(const OrderedPluginData& data);
+size_t MeasureSection(const OrderedPluginData& data, const NameTable& names);
+std::string SerializeSection(const OrderedPluginData& data, const NameTable& names);
+SerializedSections SerializeSections(const std::map<std::string, OrderedPluginData>& processedData,
+                                     const NameTable& names);
+JsonSectionIndex IndexTopLevelSections(std::string_view json);
+bool CheckIfChangesNeeded(const std::map<std::string, OrderedPluginData>& processedData);
+std::string PreserveOriginalSections(const std::string& originalJson, const JsonSectionIndex& sectionIndex,
+                                     const SerializedSections& sections, AsyncLog& logFile);
+bool WriteFileWithChecksum(const fs::path& filePath, std::string_view content, uint64_t& checksum);
+// Paso en el que falló ReplaceFileVerified: sólo con VerifyFailed se llegó a sustituir targetPath
+enum class ReplaceFileResult : uint8_t { Replaced, WriteFailed, MoveFailed, VerifyFailed };
+ReplaceFileResult ReplaceFileVerified(const fs::path& targetPath, const fs::path& tempPath, std::string_view content,
+                                      WrittenContent& written, AsyncLog& logFile);
+// written describe el archivo en disco tras cada escritura con éxito; CorrectJsonIndentation no lo
+// toca si el contenido ya tenía el formato correcto
+bool WriteJsonAtomically(const fs::path& jsonPath, const std::string& content, const BackupStore& store,
+                         WrittenContent& written, AsyncLog& logFile);
+// Reformatea a 4 espacios por nivel con los contenedores vacíos en línea, en pasadas lineales
+std::string FormatJsonCanonical(std::string_view content);
+bool CorrectJsonIndentation(const fs::path& jsonPath, const std::string& originalContent, const BackupStore& store,
+                            WrittenContent& written, AsyncLog& logFile);
+
+// ===== BACKUP, RESTAURACIÓN Y ANÁLISIS =====
+
+BackupStore ReadBackupStoreSettings(const fs::path& iniPath, const fs::path& root);
+std::string CompressBlob(std::string_view data);
+bool DecompressBlob(std::string_view blob, std::string& data);
+fs::path BackupBlobPath(const BackupStore& store, const BackupStoreEntry& entry);
+bool LoadBackupStoreManifest(const BackupStore& store, BackupStoreManifest& manifest);
+bool SaveBackupStoreManifest(const BackupStore& store, const BackupStoreManifest& manifest, AsyncLog& logFile);
+bool StoreBackupSnapshot(const BackupStore& store, std::string_view kind, std::string_view content,
+                         AsyncLog& logFile);
+bool LoadBackupSnapshot(const BackupStore& store, const BackupStoreEntry& entry, std::string& content);
+
+// La copia literal en backupJsonPath se conserva (es la que se documenta) y además se guarda en el almacén.
+// content es el JSON ya cargado de originalJsonPath: va al almacén sin volver a leer el archivo.
+bool PerformLiteralJsonBackup(const fs::path& originalJsonPath, const fs::path& backupJsonPath,
+                              std::string_view content, const BackupStore& store, AsyncLog& logFile);
+bool SaveRejectedJsonToAnalysis(std::string_view content, const BackupStore& store, AsyncLog& logFile);
+bool MoveCorruptedJsonToAnalysis(const fs::path& corruptedJsonPath, const BackupStore& store,
+                                 AsyncLog& logFile);
+// Usa la versión de backup válida más reciente del almacén; backupJsonPath (la copia literal) sólo se
+// lee si el almacén no tiene ninguna, como en instalaciones anteriores al almacén
+bool RestoreJsonFromBackup(const fs::path& backupJsonPath, const fs::path& originalJsonPath,
+                           const BackupStore& store, std::string& restoredContent, AsyncLog& logFile);
+
+// ===== ARCHIVOS DE REGLAS INI =====
+
+std::vector<fs::path> CollectRuleFilePaths(const fs::path& dataPath, AsyncLog& logFile);
+void IngestRuleFile(const fs::path& iniPath, const RuleKeySet& validKeys, IniRuleFile& ruleFile);
+std::vector<IniRuleFile> IngestRuleFilesParallel(const std::vector<fs::path>& iniPaths,
+                                                 const RuleKeySet& validKeys, NameTable& names);
+const std::vector<std::string>& GetRuleKeyList();
+int FindRuleKeyIndex(std::string_view key);
+RuleOp CompileRuleOp(size_t lineIndex, const ParsedRule& rule, NameTable& names);
+void CompileRuleFile(IniRuleFile& ruleFile, NameTable& names);
+std::vector<OrderedPluginData*> ResolveRuleKeyData(std::map<std::string, OrderedPluginData>& processedData);
+void ExecuteRuleOps(const std::vector<RuleOp>& ops, RuleCoalescer& coalescer, std::vector<IniCountUpdate>& counterUpdates,
+                    RuleApplyStats& stats, AsyncLog& logFile);
+// Con journal se devuelven las operaciones netas aplicadas a processedData, para el diario de operaciones;
+// con report se miden la aplicación y la reescritura de contadores de cada archivo
+void ApplyRuleFiles(const std::vector<IniRuleFile>& ruleFiles, std::map<std::string, OrderedPluginData>& processedData,
+                    const NameTable& names, RuleApplyStats& stats, bool updateCounters, AsyncLog& logFile,
+                    std::vector<JournalOp>* journal = nullptr, RunReport* report = nullptr);
+bool UpdateIniRuleCounts(const fs::path& iniPath, const std::string& content,
+                         const std::vector<IniCountUpdate>& updates, AsyncLog& logFile,
+                         uint64_t* bytesWritten = nullptr);
+
+// ===== CACHÉ DE EJECUCIÓN =====
+
+uint64_t HashBytes(std::string_view data, uint64_t hash = kFnvOffsetBasis);
+bool HashFileContent(const fs::path& filePath, uint64_t& hash);
+bool ComputeFingerprint(const fs::path& filePath, FileFingerprint& fingerprint);
+bool FingerprintMatches(const fs::path& filePath, const FileFingerprint& recorded);
+bool LoadRunCacheManifest(const fs::path& manifestPath, RunCacheManifest& manifest);
+bool SaveRunCacheManifest(const fs::path& manifestPath, const RunCacheManifest& manifest, AsyncLog& logFile);
+void InvalidateRunCache(const fs::path& manifestPath);
+bool IsRunCacheValid(const fs::path& manifestPath, const fs::path& jsonPath, const std::vector<fs::path>& ruleFilePaths,
+                     AsyncLog& logFile);
+bool RecordRunCache(const fs::path& manifestPath, const fs::path& jsonPath, const WrittenContent& output,
+                    const std::vector<fs::path>& ruleFilePaths, AsyncLog& logFile);
+
+// ===== DIARIO DE OPERACIONES =====
+
+bool AppendJournalRun(const fs::path& journalPath, JournalRun& run, const NameTable& names, AsyncLog& logFile);
+// Sólo se cargan las ejecuciones completas: una escritura interrumpida al final del archivo se ignora
+bool LoadOperationJournal(const fs::path& journalPath, NameTable& names, std::vector<JournalRun>& runs);
+void ApplyJournalOps(const std::vector<JournalOp>& ops, std::map<std::string, OrderedPluginData>& processedData);
+// Reconstruye en result el JSON con hash targetHash partiendo de baseContent: se encadenan las ejecuciones
+// (fromHash -> toHash) desde la que parte de baseContent y cada paso se verifica contra su hash
+bool ReplayOperationJournal(std::string_view baseContent, const std::vector<JournalRun>& runs, uint64_t targetHash,
+                            NameTable& names, std::string& result, std::string& error);
+// Reconstruye en result el JSON antes (beforeRun, --undo) o después (--replay) de run. Se prueban como base
+// las versiones de backup del almacén de la más reciente a la más antigua, después la copia literal y por
+// último el JSON actual: gana la primera desde la que el diario llega, y source la describe.
+bool RebuildJournalState(const fs::path& pluginsPath, const std::vector<JournalRun>& runs, const JournalRun& run,
+                         bool beforeRun, NameTable& names, std::string& result, std::string& source,
+                         std::string& error);
+
+// ===== INFORME DE EJECUCIÓN =====
+
+std::string FormatRunReport(const RunReport& report);
+// El log "X.log" tiene su informe en "X.report.json"
+fs::path RunReportPath(const fs::path& logFilePath);
+bool WriteRunReport(const fs::path& reportPath, const RunReport& report, AsyncLog& logFile);
+
+// ===== EJECUCIÓN COMPLETA =====
+
+struct DistributionPaths {
+    fs::path dataPath;     // Carpeta Data del juego (o de la instancia del gestor de mods)
+    fs::path logFilePath;  // Log completo de la ejecución
+};
+
+struct DistributionResult {
+    bool success = false;
+    std::string consoleMessage;
+};
+
+DistributionResult RunPresetDistribution(const DistributionPaths& paths);
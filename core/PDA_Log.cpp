@@ -0,0 +1,178 @@
+#include "core/PDA_Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+// ===== NIVELES =====
+
+LogLevel ParseLogLevel(std::string_view value, LogLevel fallback) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "error" || lower == "0") return LogLevel::Error;
+    if (lower == "summary" || lower == "1") return LogLevel::Summary;
+    if (lower == "detail" || lower == "2") return LogLevel::RuleDetail;
+    return fallback;
+}
+
+const char* LogLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Error:
+            return "error";
+        case LogLevel::Summary:
+            return "summary";
+        case LogLevel::RuleDetail:
+            return "detail";
+    }
+    return "detail";
+}
+
+// ===== BUFFER DE LÍNEA (HILO PRODUCTOR) =====
+
+AsyncLog::LineBuffer::LineBuffer(AsyncLog& owner) : owner(owner) { setp(line, line + sizeof(line)); }
+
+void AsyncLog::LineBuffer::commit() {
+    if (pptr() != pbase() && owner.lineLevel <= owner.level && owner.is_open()) {
+        owner.push(pbase(), static_cast<size_t>(pptr() - pbase()));
+    }
+    setp(line, line + sizeof(line));
+}
+
+AsyncLog::LineBuffer::int_type AsyncLog::LineBuffer::overflow(int_type ch) {
+    // Una línea más larga que el buffer se pasa al anillo por trozos con el mismo nivel
+    commit();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int AsyncLog::LineBuffer::sync() {
+    commit();
+    owner.lineLevel = LogLevel::Summary;
+    return 0;
+}
+
+// ===== ANILLO Y ESCRITOR =====
+
+AsyncLog::AsyncLog() : std::ostream(nullptr), buffer(*this) {
+    rdbuf(&buffer);
+    setstate(std::ios::badbit);  // Cerrado: los << no hacen nada
+}
+
+AsyncLog::AsyncLog(const std::filesystem::path& path, LogLevel level) : AsyncLog() {
+    this->level = level;
+    open(path);
+}
+
+AsyncLog::~AsyncLog() { close(); }
+
+bool AsyncLog::open(const std::filesystem::path& path) {
+    close();
+
+    file.open(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    if (!ring) {
+        ring = std::make_unique<char[]>(kRingCapacity);
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    stopping = false;
+    wakeRequested = false;
+    lineLevel = LogLevel::Summary;
+
+    writer = std::thread(&AsyncLog::writerLoop, this);
+    clear();
+    return true;
+}
+
+void AsyncLog::close() {
+    if (!writer.joinable()) return;
+
+    buffer.commit();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeSignal.notify_one();
+    writer.join();
+
+    file.close();
+    setstate(std::ios::badbit);
+}
+
+AsyncLog& AsyncLog::at(LogLevel value) {
+    // Lo pendiente de la línea anterior (terminada en '\n' sin std::endl) conserva su nivel
+    buffer.commit();
+    lineLevel = value;
+    return *this;
+}
+
+void AsyncLog::push(const char* data, size_t size) {
+    while (size > 0) {
+        size_t write = head.load(std::memory_order_relaxed);
+        size_t used = write - tail.load(std::memory_order_acquire);
+        size_t space = kRingCapacity - used;
+        if (space == 0) {
+            // Anillo lleno: el escritor va por detrás; se espera a que libere espacio sin perder nada
+            wakeWriter();
+            std::this_thread::yield();
+            continue;
+        }
+
+        size_t chunk = std::min(size, space);
+        size_t offset = write & (kRingCapacity - 1);
+        size_t first = std::min(chunk, kRingCapacity - offset);
+        std::memcpy(ring.get() + offset, data, first);
+        std::memcpy(ring.get(), data + first, chunk - first);
+        head.store(write + chunk, std::memory_order_release);
+
+        data += chunk;
+        size -= chunk;
+        // El escritor se despierta solo cada pocos milisegundos; sólo se le avisa si el anillo se llena
+        if (used + chunk >= kRingCapacity / 2 && used < kRingCapacity / 2) {
+            wakeWriter();
+        }
+    }
+}
+
+void AsyncLog::wakeWriter() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeSignal.notify_one();
+}
+
+void AsyncLog::writerLoop() {
+    constexpr auto kDrainInterval = std::chrono::milliseconds(10);
+
+    while (true) {
+        size_t read = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - read;
+
+        if (available > 0) {
+            size_t offset = read & (kRingCapacity - 1);
+            size_t first = std::min(available, kRingCapacity - offset);
+            file.write(ring.get() + offset, static_cast<std::streamsize>(first));
+            file.write(ring.get(), static_cast<std::streamsize>(available - first));
+            tail.store(read + available, std::memory_order_release);
+            file.flush();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping) {
+            // close() pasó la última línea al anillo antes de pedir la parada: se termina al vaciarlo
+            if (head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed)) break;
+            continue;
+        }
+        wakeSignal.wait_for(lock, kDrainInterval, [this] { return wakeRequested || stopping; });
+        wakeRequested = false;
+    }
+}
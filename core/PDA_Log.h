@@ -0,0 +1,94 @@
+#pragma once
+
+// ===== LOG ASÍNCRONO CON NIVELES =====
+// Sustituye al std::ofstream del log. El hilo que procesa formatea en un buffer de línea propio y cada
+// std::endl sólo copia la línea a un anillo de bytes sin bloqueos (un productor, un consumidor); un
+// hilo escritor vacía el anillo al archivo por lotes. Así std::endl deja de ser una escritura y un
+// flush por línea, y el bucle de reglas no espera al disco.
+//
+// Niveles: Error (errores y avisos), Summary (etapas, archivos y totales) y RuleDetail (una línea por
+// regla). Lo que se escribe con << es Summary; error() y detail() cambian el nivel de lo que se
+// escriba hasta el siguiente std::endl. Las líneas por encima del nivel configurado se descartan.
+//
+// Sólo un hilo a la vez puede escribir en un mismo AsyncLog. Sin abrir, todo lo escrito se descarta
+// (igual que con un std::ofstream cerrado).
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+
+enum class LogLevel { Error = 0, Summary = 1, RuleDetail = 2 };
+
+// "error", "summary" o "detail" (también 0, 1 y 2); cualquier otro valor da fallback
+LogLevel ParseLogLevel(std::string_view value, LogLevel fallback);
+const char* LogLevelName(LogLevel level);
+
+class AsyncLog : public std::ostream {
+public:
+    AsyncLog();
+    explicit AsyncLog(const std::filesystem::path& path, LogLevel level = LogLevel::RuleDetail);
+    ~AsyncLog() override;
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    // Vacía todo lo pendiente al archivo y detiene el hilo escritor
+    void close();
+    bool is_open() const { return writer.joinable(); }
+
+    void setLevel(LogLevel value) { level = value; }
+    LogLevel getLevel() const { return level; }
+    // Para no formatear en absoluto lo que se va a descartar
+    bool enabled(LogLevel lineLevel) const { return is_open() && lineLevel <= level; }
+
+    AsyncLog& error() { return at(LogLevel::Error); }
+    AsyncLog& detail() { return at(LogLevel::RuleDetail); }
+
+private:
+    // Buffer de la línea en curso; sync() (std::endl) la pasa al anillo o la descarta según su nivel
+    class LineBuffer : public std::streambuf {
+    public:
+        explicit LineBuffer(AsyncLog& owner);
+        void commit();
+
+    protected:
+        int_type overflow(int_type ch) override;
+        int sync() override;
+
+    private:
+        AsyncLog& owner;
+        char line[4096];
+    };
+
+    AsyncLog& at(LogLevel lineLevel);
+    void push(const char* data, size_t size);
+    void wakeWriter();
+    void writerLoop();
+
+    static constexpr size_t kRingCapacity = size_t(1) << 20;
+
+    LineBuffer buffer;
+    LogLevel level = LogLevel::RuleDetail;
+    LogLevel lineLevel = LogLevel::Summary;
+
+    // Anillo de bytes: head sólo lo avanza el productor y tail sólo el escritor (contadores monótonos)
+    std::unique_ptr<char[]> ring;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+
+    std::ofstream file;
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    bool wakeRequested = false;
+    bool stopping = false;
+};
@@ -0,0 +1,179 @@
+#include "core/PDA_Memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+// ===== CONTADORES GLOBALES =====
+
+namespace {
+std::atomic<bool> trackingEnabled{false};
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<int64_t> liveBytes{0};  // Absolutos, desde el arranque del proceso
+std::atomic<int64_t> peakLiveBytes{0};
+std::atomic<int64_t> baselineLiveBytes{0};
+
+void RaisePeak(int64_t value) {
+    int64_t peak = peakLiveBytes.load(std::memory_order_relaxed);
+    while (value > peak && !peakLiveBytes.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Tamaño real del bloque: el mismo al asignar y al liberar, sin guardar cabeceras propias
+size_t BlockSize(void* block, std::size_t alignment) {
+#if defined(_WIN32)
+    return alignment > 0 ? _aligned_msize(block, alignment, 0) : _msize(block);
+#elif defined(__APPLE__)
+    (void)alignment;
+    return malloc_size(block);
+#else
+    (void)alignment;
+    return malloc_usable_size(block);
+#endif
+}
+
+void RecordAllocation(void* block, std::size_t size, std::size_t alignment) {
+    int64_t blockSize = static_cast<int64_t>(BlockSize(block, alignment));
+    int64_t live = liveBytes.fetch_add(blockSize, std::memory_order_relaxed) + blockSize;
+    if (trackingEnabled.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        RaisePeak(live);
+    }
+}
+
+void* Allocate(std::size_t size, std::size_t alignment) {
+    if (size == 0) size = 1;
+
+    while (true) {
+        void* block = nullptr;
+        if (alignment == 0) {
+            block = std::malloc(size);
+        } else {
+#if defined(_WIN32)
+            block = _aligned_malloc(size, alignment);
+#else
+            // aligned_alloc exige un tamaño múltiplo del alineamiento
+            block = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+        }
+
+        if (block != nullptr) {
+            RecordAllocation(block, size, alignment);
+            return block;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) return nullptr;
+        handler();
+    }
+}
+
+void Release(void* block, std::size_t alignment) {
+    if (block == nullptr) return;
+
+    // Siempre, para que un bloque de una ejecución liberado con el seguimiento ya desactivado se reste
+    liveBytes.fetch_sub(static_cast<int64_t>(BlockSize(block, alignment)), std::memory_order_relaxed);
+#if defined(_WIN32)
+    if (alignment > 0) {
+        _aligned_free(block);
+        return;
+    }
+#endif
+    std::free(block);
+}
+
+void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+    void* block = Allocate(size, alignment);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+}  // namespace
+
+void SetAllocationTracking(bool enabled) {
+    if (enabled) {
+        int64_t live = liveBytes.load(std::memory_order_relaxed);
+        baselineLiveBytes.store(live, std::memory_order_relaxed);
+        peakLiveBytes.store(live, std::memory_order_relaxed);
+        allocationCount.store(0, std::memory_order_relaxed);
+        allocatedBytes.store(0, std::memory_order_relaxed);
+    }
+    trackingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTrackingEnabled() { return trackingEnabled.load(std::memory_order_relaxed); }
+
+AllocationCounters ReadAllocationCounters() {
+    AllocationCounters counters;
+    counters.allocations = allocationCount.load(std::memory_order_relaxed);
+    counters.bytesAllocated = allocatedBytes.load(std::memory_order_relaxed);
+    counters.liveBytes =
+        liveBytes.load(std::memory_order_relaxed) - baselineLiveBytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+int64_t PeakLiveBytes() {
+    return peakLiveBytes.load(std::memory_order_relaxed) - baselineLiveBytes.load(std::memory_order_relaxed);
+}
+
+int64_t ResetPeakLiveBytes() {
+    int64_t previous = peakLiveBytes.exchange(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return previous - baselineLiveBytes.load(std::memory_order_relaxed);
+}
+
+void RaisePeakLiveBytes(int64_t value) { RaisePeak(value + baselineLiveBytes.load(std::memory_order_relaxed)); }
+
+// ===== SUSTITUCIÓN DEL OPERATOR NEW/DELETE GLOBAL =====
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* block) noexcept { Release(block, 0); }
+void operator delete[](void* block) noexcept { Release(block, 0); }
+void operator delete(void* block, std::size_t) noexcept { Release(block, 0); }
+void operator delete[](void* block, std::size_t) noexcept { Release(block, 0); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { Release(block, 0); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { Release(block, 0); }
+
+void operator delete(void* block, std::align_val_t alignment) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* block, std::align_val_t alignment) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* block, std::size_t, std::align_val_t alignment) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* block, std::size_t, std::align_val_t alignment) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    Release(block, static_cast<std::size_t>(alignment));
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// ===== CONTABILIDAD DE ASIGNACIONES =====
+// Modo de diagnóstico opcional, sólo en compilaciones con PDA_TRACK_ALLOCATIONS: entonces PDA_Memory.cpp
+// sustituye el operator new/delete global del binario que enlaza el núcleo y cuenta los bytes vivos (con
+// el tamaño real del bloque que da el asignador) y, con el seguimiento activado, las asignaciones y los
+// bytes pedidos. Sin la opción no se sustituye nada y estas funciones no hacen nada.
+//
+// Los bytes vivos se cuentan siempre, y al activar el seguimiento se toma como línea base su valor en
+// ese momento: liveBytes y los picos son relativos a ella, así que la memoria que ya existía no cuenta
+// y lo que se libere después se sigue restando. Pueden ser negativos si se libera memoria anterior. Los
+// contadores son atómicos: los hilos de ingesta también cuentan.
+
+#include <cstdint>
+
+struct AllocationCounters {
+    uint64_t allocations = 0;
+    uint64_t bytesAllocated = 0;
+    int64_t liveBytes = 0;
+};
+
+#if defined(PDA_TRACK_ALLOCATIONS)
+
+// Activarlo toma una nueva línea base y pone a cero los contadores y el pico
+void SetAllocationTracking(bool enabled);
+bool AllocationTrackingEnabled();
+AllocationCounters ReadAllocationCounters();
+
+// Máximo de liveBytes desde el último reinicio. ResetPeakLiveBytes lo lleva a los bytes vivos actuales
+// y devuelve el pico anterior; RaisePeakLiveBytes lo vuelve a subir (etapas anidadas).
+int64_t PeakLiveBytes();
+int64_t ResetPeakLiveBytes();
+void RaisePeakLiveBytes(int64_t value);
+
+#else
+
+inline void SetAllocationTracking(bool) {}
+inline bool AllocationTrackingEnabled() { return false; }
+inline AllocationCounters ReadAllocationCounters() { return {}; }
+inline int64_t PeakLiveBytes() { return 0; }
+inline int64_t ResetPeakLiveBytes() { return 0; }
+inline void RaisePeakLiveBytes(int64_t) {}
+
+#endif
@@ -0,0 +1,208 @@
+#include "core/PDA_StructuralScanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "core/PDA_StructuralScannerBlocks.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PDA_HAVE_SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+
+// ===== KERNELS DE CLASIFICACIÓN =====
+
+namespace {
+struct ScalarKernel {
+    static BlockMasks Classify(const char* block) {
+        BlockMasks masks;
+        for (int i = 0; i < 64; i++) {
+            uint64_t bit = uint64_t{1} << i;
+            switch (block[i]) {
+                case '\\':
+                    masks.backslash |= bit;
+                    break;
+                case '"':
+                    masks.quote |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case '(':
+                case ')':
+                case ':':
+                case ',':
+                    masks.structural |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return masks;
+    }
+};
+
+#if defined(PDA_HAVE_SSE2_KERNEL)
+struct Sse2Kernel {
+    static uint64_t Mask16(__m128i matches) {
+        return static_cast<uint16_t>(_mm_movemask_epi8(matches));
+    }
+
+    static uint64_t Structural16(__m128i bytes) {
+        // '[' y '{' (y ']' y '}') sólo difieren en el bit 0x20; '(' y ')' sólo en el bit 0x01
+        __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        __m128i parens = _mm_and_si128(bytes, _mm_set1_epi8(static_cast<char>(0xFE)));
+        __m128i matches =
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(parens, _mm_set1_epi8('(')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')));
+        return Mask16(matches);
+    }
+
+    static BlockMasks Classify(const char* block) {
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i quote = _mm_set1_epi8('"');
+
+        BlockMasks masks;
+        for (int part = 0; part < 4; part++) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + part * 16));
+            int shift = part * 16;
+            masks.backslash |= Mask16(_mm_cmpeq_epi8(bytes, backslash)) << shift;
+            masks.quote |= Mask16(_mm_cmpeq_epi8(bytes, quote)) << shift;
+            masks.structural |= Structural16(bytes) << shift;
+        }
+        return masks;
+    }
+};
+#endif
+
+using ScanBlocksFn = size_t (*)(const char*, size_t, uint32_t, StructuralScanState&, uint32_t*);
+
+ScanBlocksFn SelectKernel(StructuralKernel kernel) {
+    switch (kernel) {
+#if defined(PDA_HAVE_AVX2_KERNEL)
+        case StructuralKernel::Avx2:
+            return ScanStructuralBlocksAvx2;
+#endif
+#if defined(PDA_HAVE_SSE2_KERNEL)
+        case StructuralKernel::Sse2:
+            return ScanStructuralBlocks<Sse2Kernel>;
+#endif
+        default:
+            return ScanStructuralBlocks<ScalarKernel>;
+    }
+}
+
+bool CpuSupportsAvx2() {
+#if !defined(PDA_HAVE_AVX2_KERNEL)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // AVX2 exige además que el sistema operativo guarde los registros YMM (OSXSAVE + XCR0)
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+}  // namespace
+
+// ===== SELECCIÓN DEL KERNEL =====
+
+bool StructuralKernelSupported(StructuralKernel kernel) {
+    switch (kernel) {
+        case StructuralKernel::Avx2: {
+            static const bool supported = CpuSupportsAvx2();
+            return supported;
+        }
+        case StructuralKernel::Sse2:
+#if defined(PDA_HAVE_SSE2_KERNEL)
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return true;
+    }
+}
+
+StructuralKernel ActiveStructuralKernel() {
+    if (StructuralKernelSupported(StructuralKernel::Avx2)) return StructuralKernel::Avx2;
+    if (StructuralKernelSupported(StructuralKernel::Sse2)) return StructuralKernel::Sse2;
+    return StructuralKernel::Scalar;
+}
+
+const char* StructuralKernelName(StructuralKernel kernel) {
+    switch (kernel) {
+        case StructuralKernel::Avx2:
+            return "AVX2";
+        case StructuralKernel::Sse2:
+            return "SSE2";
+        default:
+            return "scalar";
+    }
+}
+
+// ===== ESCANEO =====
+
+JsonStructuralIndex ScanJsonStructure(std::string_view json) {
+    static const StructuralKernel activeKernel = ActiveStructuralKernel();
+    return ScanJsonStructure(json, activeKernel);
+}
+
+JsonStructuralIndex ScanJsonStructure(std::string_view json, StructuralKernel kernel) {
+    if (json.size() > UINT32_MAX) {
+        throw std::length_error("JSON too large for the structural index");
+    }
+    if (!StructuralKernelSupported(kernel)) {
+        kernel = ActiveStructuralKernel();
+    }
+    ScanBlocksFn scanBlocks = SelectKernel(kernel);
+
+    // Se procesan tramos de bloques: antes de cada tramo se garantiza sitio para el peor caso (todos
+    // los bytes estructurales) y las posiciones se escriben directamente en el vector
+    constexpr size_t kChunkBlocks = 1024;
+    JsonStructuralIndex index;
+    StructuralScanState state;
+    size_t count = 0;
+    auto reserveFor = [&index, &count](size_t blocks) {
+        size_t needed = count + blocks * 64;
+        if (index.positions.size() < needed) {
+            index.positions.resize(std::max(needed, index.positions.size() * 2));
+        }
+    };
+
+    const size_t fullBlocks = json.size() / 64;
+    for (size_t block = 0; block < fullBlocks; block += kChunkBlocks) {
+        size_t blocks = std::min(kChunkBlocks, fullBlocks - block);
+        reserveFor(blocks);
+        count += scanBlocks(json.data() + block * 64, blocks, static_cast<uint32_t>(block * 64), state,
+                            index.positions.data() + count);
+    }
+
+    // El último bloque incompleto se rellena con espacios, que nunca son estructurales
+    size_t tail = json.size() % 64;
+    if (tail != 0) {
+        char padded[64];
+        std::memset(padded, ' ', sizeof(padded));
+        std::memcpy(padded, json.data() + fullBlocks * 64, tail);
+        reserveFor(1);
+        count += scanBlocks(padded, 1, static_cast<uint32_t>(fullBlocks * 64), state, index.positions.data() + count);
+    }
+
+    index.positions.resize(count);
+    index.unterminatedString = state.prevInString != 0;
+    return index;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// ===== ESCÁNER ESTRUCTURAL DEL JSON =====
+// Primera etapa común de todo lo que recorre el JSON (validaciones, índice de secciones, parser de
+// plugins y reformateo), al estilo de la etapa 1 de simdjson: en bloques de 64 bytes localiza los
+// caracteres estructurales que quedan fuera de cadenas y las comillas que abren y cierran cada cadena.
+// Una barra invertida escapa el byte siguiente, dentro o fuera de una cadena, y un byte escapado nunca
+// es estructural. Los consumidores saltan de una posición a la siguiente en lugar de llevar su propia
+// máquina de estados byte a byte.
+//
+// La clasificación de cada bloque usa AVX2 o SSE2 según la CPU, con una versión escalar para el resto
+// de plataformas. Todas producen exactamente el mismo índice.
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+enum class StructuralKernel { Scalar, Sse2, Avx2 };
+
+struct JsonStructuralIndex {
+    // Posiciones en orden de { } [ ] ( ) : , fuera de cadenas y de cada comilla no escapada (las
+    // comillas alternan apertura y cierre). Los paréntesis se indexan porque la verificación de
+    // integridad inicial los cuenta.
+    std::vector<uint32_t> positions;
+    bool unterminatedString = false;  // La última cadena llega al final del texto sin cerrarse
+};
+
+// Lanza std::length_error si el texto no cabe en posiciones de 32 bits (4 GB)
+JsonStructuralIndex ScanJsonStructure(std::string_view json);
+JsonStructuralIndex ScanJsonStructure(std::string_view json, StructuralKernel kernel);
+
+// El mejor kernel disponible en esta CPU (el que usa ScanJsonStructure sin argumento)
+StructuralKernel ActiveStructuralKernel();
+bool StructuralKernelSupported(StructuralKernel kernel);
+const char* StructuralKernelName(StructuralKernel kernel);
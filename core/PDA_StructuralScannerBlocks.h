@@ -0,0 +1,102 @@
+#pragma once
+
+// ===== BLOQUES DEL ESCÁNER ESTRUCTURAL (USO INTERNO) =====
+// Cada kernel sólo clasifica 64 bytes en tres máscaras de bits; el cálculo de escapes, cadenas y la
+// extracción de posiciones es común. Lo incluyen únicamente los PDA_StructuralScanner*.cpp. Todo lo
+// que no es la interfaz entre ellos queda en un espacio de nombres anónimo y no usa plantillas de la
+// biblioteca estándar: la unidad AVX2 se compila con otras opciones de CPU y ninguna función suya
+// puede acabar sustituyendo a la copia que usan los demás kernels al enlazar.
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Estado que pasa de un bloque al siguiente
+struct StructuralScanState {
+    uint64_t prevEscaped = 0;   // 1 si el primer byte del bloque siguiente está escapado
+    uint64_t prevInString = 0;  // Todo unos si el bloque siguiente empieza dentro de una cadena
+};
+
+#if defined(PDA_HAVE_AVX2_KERNEL)
+// Kernel AVX2 (PDA_StructuralScanner_AVX2.cpp): sólo debe llamarse si la CPU soporta AVX2
+size_t ScanStructuralBlocksAvx2(const char* data, size_t blockCount, uint32_t base, StructuralScanState& state,
+                                uint32_t* out);
+#endif
+
+namespace {
+struct BlockMasks {
+    uint64_t backslash = 0;
+    uint64_t quote = 0;
+    uint64_t structural = 0;  // { } [ ] ( ) : , sin tener en cuenta cadenas ni escapes
+};
+
+inline int TrailingZeros(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// Bytes escapados: el siguiente a cada secuencia de barras invertidas de longitud impar. Las
+// secuencias que empiezan en bit par o impar se separan con una suma, sin recorrerlas.
+inline uint64_t FindEscaped(uint64_t backslash, uint64_t& prevEscaped) {
+    constexpr uint64_t kEvenBits = 0x5555555555555555ULL;
+
+    if (backslash == 0) {
+        uint64_t escaped = prevEscaped;
+        prevEscaped = 0;
+        return escaped;
+    }
+
+    // Una barra escapada por el bloque anterior no empieza secuencia
+    backslash &= ~prevEscaped;
+    uint64_t followsEscape = (backslash << 1) | prevEscaped;
+    uint64_t oddSequenceStarts = backslash & ~kEvenBits & ~followsEscape;
+    uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+    prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;  // Acarreo: la secuencia sigue
+    uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+    return (kEvenBits ^ invertMask) & followsEscape;
+}
+
+// Bit i = XOR de los bits 0..i: marca el interior de las cadenas a partir de sus comillas
+inline uint64_t PrefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Recorre blockCount bloques completos de 64 bytes y escribe en out las posiciones (base + desplazamiento)
+// de los bytes estructurales y las comillas. out debe tener sitio para 64 posiciones por bloque.
+template <typename Kernel>
+inline size_t ScanStructuralBlocks(const char* data, size_t blockCount, uint32_t base, StructuralScanState& state,
+                                   uint32_t* out) {
+    uint32_t* cursor = out;
+    for (size_t block = 0; block < blockCount; block++) {
+        BlockMasks masks = Kernel::Classify(data + block * 64);
+
+        uint64_t escaped = FindEscaped(masks.backslash, state.prevEscaped);
+        uint64_t quotes = masks.quote & ~escaped;
+        // El interior incluye la comilla de apertura y excluye la de cierre
+        uint64_t inString = PrefixXor(quotes) ^ state.prevInString;
+        state.prevInString = 0 - (inString >> 63);
+
+        uint64_t bits = (masks.structural & ~inString & ~escaped) | quotes;
+        uint32_t blockBase = base + static_cast<uint32_t>(block * 64);
+        while (bits != 0) {
+            *cursor++ = blockBase + static_cast<uint32_t>(TrailingZeros(bits));
+            bits &= bits - 1;
+        }
+    }
+    return static_cast<size_t>(cursor - out);
+}
+}  // namespace
@@ -0,0 +1,45 @@
+// ===== KERNEL AVX2 DEL ESCÁNER ESTRUCTURAL =====
+// Se compila con AVX2 activado (ver CMakeLists.txt) y sólo se llama tras comprobar la CPU en tiempo de
+// ejecución. No incluye nada de la biblioteca estándar: ver PDA_StructuralScannerBlocks.h.
+
+#include <immintrin.h>
+
+#include "core/PDA_StructuralScannerBlocks.h"
+
+namespace {
+struct Avx2Kernel {
+    static uint64_t Mask32(__m256i matches) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    }
+
+    static uint64_t Structural32(__m256i bytes) {
+        // '[' y '{' (y ']' y '}') sólo difieren en el bit 0x20; '(' y ')' sólo en el bit 0x01
+        __m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+        __m256i parens = _mm256_and_si256(bytes, _mm256_set1_epi8(static_cast<char>(0xFE)));
+        __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                          _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(parens, _mm256_set1_epi8('(')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(',')));
+        return Mask32(matches);
+    }
+
+    static BlockMasks Classify(const char* block) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i quote = _mm256_set1_epi8('"');
+
+        BlockMasks masks;
+        masks.backslash = Mask32(_mm256_cmpeq_epi8(low, backslash)) | (Mask32(_mm256_cmpeq_epi8(high, backslash)) << 32);
+        masks.quote = Mask32(_mm256_cmpeq_epi8(low, quote)) | (Mask32(_mm256_cmpeq_epi8(high, quote)) << 32);
+        masks.structural = Structural32(low) | (Structural32(high) << 32);
+        return masks;
+    }
+};
+}  // namespace
+
+size_t ScanStructuralBlocksAvx2(const char* data, size_t blockCount, uint32_t base, StructuralScanState& state,
+                                uint32_t* out) {
+    return ScanStructuralBlocks<Avx2Kernel>(data, blockCount, base, state, out);
+}
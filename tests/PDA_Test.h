@@ -0,0 +1,83 @@
+#pragma once
+
+// ===== MINI ARNÉS DE PRUEBAS =====
+// Sin dependencias externas: cada PDA_TEST se registra en una tabla global y "PDA_Tests <suite>" ejecuta
+// las pruebas de esa suite (CMake registra una entrada de ctest por suite). Un CHECK fallido anota el
+// error con su archivo y línea y la prueba sigue; una excepción sin capturar hace fallar sólo esa prueba.
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/PDA_Core.h"
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*body)();
+};
+
+std::vector<TestCase>& TestRegistry();
+void ReportFailure(const char* file, int line, const std::string& message);
+
+struct TestRegistration {
+    TestRegistration(const char* suite, const char* name, void (*body)()) {
+        TestRegistry().push_back({suite, name, body});
+    }
+};
+
+#define PDA_TEST(suite, name)                                                                           \
+    static void suite##_##name();                                                                       \
+    static const TestRegistration suite##_##name##_registration(#suite, #name, &suite##_##name);        \
+    static void suite##_##name()
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) ReportFailure(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                        \
+    do {                                                                                  \
+        const auto& actualValue = (actual);                                               \
+        const auto& expectedValue = (expected);                                           \
+        if (!(actualValue == expectedValue)) {                                            \
+            std::ostringstream message;                                                   \
+            message << #actual << " == " << #expected << " (got " << actualValue << ", expected " \
+                    << expectedValue << ")";                                              \
+            ReportFailure(__FILE__, __LINE__, message.str());                             \
+        }                                                                                 \
+    } while (0)
+
+// ===== AYUDAS PARA ARCHIVOS =====
+
+// Ruta dentro de tests/fixtures
+fs::path FixturePath(std::string_view relative);
+
+std::string ReadFileBytes(const fs::path& path);
+void WriteFileBytes(const fs::path& path, std::string_view content);
+
+// Carpeta temporal propia de una prueba: se vacía al crearla y se borra al salir
+struct ScratchDir {
+    explicit ScratchDir(std::string_view name);
+    ~ScratchDir();
+
+    ScratchDir(const ScratchDir&) = delete;
+    ScratchDir& operator=(const ScratchDir&) = delete;
+
+    fs::path path;
+};
+
+// Carpeta Data mínima para RunPresetDistribution: el JSON de partida, el INI de configuración y los
+// OBodyNG_PDA_*.ini (nombre, contenido)
+struct TestDataDir {
+    TestDataDir(std::string_view name, std::string_view json, std::string_view configIni,
+                const std::vector<std::pair<std::string, std::string>>& ruleFiles);
+
+    fs::path pluginsPath() const { return scratch.path / "SKSE" / "Plugins"; }
+    fs::path jsonPath() const { return pluginsPath() / "OBody_presetDistributionConfig.json"; }
+    DistributionResult run() const;
+
+    ScratchDir scratch;
+};
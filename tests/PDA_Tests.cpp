@@ -0,0 +1,106 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "tests/PDA_Test.h"
+
+// ===== EJECUTOR DE PRUEBAS =====
+// Uso: PDA_Tests [suite]  (sin argumentos ejecuta todas las suites; --list las enumera)
+
+#ifndef PDA_TEST_FIXTURES_DIR
+#define PDA_TEST_FIXTURES_DIR "tests/fixtures"
+#endif
+
+namespace {
+int currentFailures = 0;
+}
+
+std::vector<TestCase>& TestRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+void ReportFailure(const char* file, int line, const std::string& message) {
+    currentFailures++;
+    std::cout << "    " << file << ":" << line << ": CHECK failed: " << message << std::endl;
+}
+
+fs::path FixturePath(std::string_view relative) { return fs::path(PDA_TEST_FIXTURES_DIR) / relative; }
+
+std::string ReadFileBytes(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+void WriteFileBytes(const fs::path& path, std::string_view content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+ScratchDir::ScratchDir(std::string_view name) : path(fs::temp_directory_path() / "PDA_Tests" / name) {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+    fs::create_directories(path);
+}
+
+ScratchDir::~ScratchDir() {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+}
+
+TestDataDir::TestDataDir(std::string_view name, std::string_view json, std::string_view configIni,
+                         const std::vector<std::pair<std::string, std::string>>& ruleFiles)
+    : scratch(name) {
+    WriteFileBytes(jsonPath(), json);
+    WriteFileBytes(pluginsPath() / "OBody_NG_Preset_Distribution_Assistant_NG.ini", configIni);
+    for (const auto& [fileName, content] : ruleFiles) {
+        WriteFileBytes(scratch.path / fileName, content);
+    }
+}
+
+DistributionResult TestDataDir::run() const {
+    DistributionPaths paths;
+    paths.dataPath = scratch.path;
+    paths.logFilePath = scratch.path / "PDA_Tests.log";
+    return RunPresetDistribution(paths);
+}
+
+int main(int argc, char* argv[]) {
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+
+    if (suite != nullptr && std::strcmp(suite, "--list") == 0) {
+        for (const auto& test : TestRegistry()) {
+            std::cout << test.suite << "." << test.name << std::endl;
+        }
+        return 0;
+    }
+
+    int ran = 0;
+    int failed = 0;
+    for (const auto& test : TestRegistry()) {
+        if (suite != nullptr && std::strcmp(suite, test.suite) != 0) continue;
+
+        std::cout << "[ RUN  ] " << test.suite << "." << test.name << std::endl;
+        currentFailures = 0;
+        try {
+            test.body();
+        } catch (const std::exception& e) {
+            ReportFailure(__FILE__, __LINE__, std::string("exception: ") + e.what());
+        } catch (...) {
+            ReportFailure(__FILE__, __LINE__, "unknown exception");
+        }
+        ran++;
+        if (currentFailures > 0) failed++;
+        std::cout << (currentFailures > 0 ? "[ FAIL ] " : "[  OK  ] ") << test.suite << "." << test.name
+                  << std::endl;
+    }
+
+    if (ran == 0) {
+        std::cout << "No tests in suite " << (suite != nullptr ? suite : "(all)") << std::endl;
+        return 1;
+    }
+    std::cout << ran - failed << "/" << ran << " tests passed" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
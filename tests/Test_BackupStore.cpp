@@ -0,0 +1,353 @@
+#include <random>
+
+#include "tests/PDA_Test.h"
+
+// ===== ALMACÉN DE BACKUPS Y FORMATO PDLZ =====
+// Los blobs comprimidos son la única copia de los backups: la compresión tiene que ser exacta, un blob
+// truncado o dañado nunca puede devolverse como si fuera la versión guardada, y la retención sólo puede
+// borrar lo que ella misma descarta.
+
+namespace {
+std::string RandomBytes(std::mt19937_64& rng, size_t size) {
+    std::string data(size, '\0');
+    for (auto& c : data) c = static_cast<char>(rng() & 0xFF);
+    return data;
+}
+
+// Texto con la forma de un JSON de presets: muy repetitivo, con coincidencias cortas y largas
+std::string PresetLikeJson(std::mt19937_64& rng, size_t size) {
+    std::string data = "{\n    \"npcPluginFemale\": {\n";
+    while (data.size() < size) {
+        data += "        \"Mod_" + std::to_string(rng() % 5000) + ".esp\": [\n            \"Preset_" +
+                std::to_string(rng() % 2000) + "\"\n        ],\n";
+    }
+    data.resize(size);
+    return data;
+}
+
+std::vector<std::string> RoundTripInputs() {
+    std::mt19937_64 rng(21);
+    std::vector<std::string> inputs = {"", "a", "abcd", "abcdabcdabcd", std::string(15, 'x'), std::string(16, 'x'),
+                                       std::string(270, 'x'), std::string(300 * 1024, '\0')};
+    for (size_t size : {size_t{1}, size_t{14}, size_t{15}, size_t{255}, size_t{4096}, size_t{70000},
+                        size_t{300 * 1024}}) {
+        inputs.push_back(RandomBytes(rng, size));
+        inputs.push_back(PresetLikeJson(rng, size));
+    }
+    // Repeticiones más allá del desplazamiento máximo (65535) y mezcla de tramos aleatorios y repetidos
+    std::string mixed = RandomBytes(rng, 70000);
+    mixed += mixed.substr(0, 20000);
+    mixed += std::string(1000, 'z') + RandomBytes(rng, 10);
+    inputs.push_back(mixed);
+    return inputs;
+}
+
+// Un JSON válido mínimo y distinto por versión, para guardar versiones distinguibles
+std::string VersionContent(int version) {
+    return "{\n    \"npc\": {\n        \"Mod_" + std::to_string(version) + ".esp\": [\n            \"Preset\"\n"
+           "        ]\n    }\n}\n" + std::string(200, ' ');
+}
+
+BackupStore MakeStore(const ScratchDir& scratch, size_t keepVersions, bool compress) {
+    BackupStore store;
+    store.root = scratch.path / "Store";
+    store.keepVersions = keepVersions;
+    store.compress = compress;
+    return store;
+}
+
+size_t CountBlobs(const BackupStore& store) {
+    size_t count = 0;
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(store.root / "objects", ec)) {
+        if (file.is_regular_file()) count++;
+    }
+    return count;
+}
+
+std::vector<BackupStoreEntry> EntriesOfKind(const BackupStoreManifest& manifest, std::string_view kind) {
+    std::vector<BackupStoreEntry> entries;
+    for (const auto& entry : manifest.entries) {
+        if (entry.kind == kind) entries.push_back(entry);
+    }
+    return entries;
+}
+}  // namespace
+
+// ----- Formato PDLZ -----
+
+PDA_TEST(BackupStore, BlobRoundTrips) {
+    for (const auto& input : RoundTripInputs()) {
+        std::string blob = CompressBlob(input);
+        std::string output;
+        CHECK(DecompressBlob(blob, output));
+        if (output != input) {
+            ReportFailure(__FILE__, __LINE__, "round trip differs for " + std::to_string(input.size()) + " bytes");
+        }
+    }
+}
+
+PDA_TEST(BackupStore, RepetitiveInputsCompress) {
+    std::mt19937_64 rng(5);
+    std::string json = PresetLikeJson(rng, 200 * 1024);
+    CHECK(CompressBlob(json).size() < json.size() / 2);
+    CHECK(CompressBlob(std::string(300 * 1024, '\0')).size() < 2048);
+}
+
+PDA_TEST(BackupStore, RejectsTruncatedBlobs) {
+    std::mt19937_64 rng(7);
+    for (const auto& input : {PresetLikeJson(rng, 3000), RandomBytes(rng, 600), std::string(5000, 'q')}) {
+        std::string blob = CompressBlob(input);
+        std::string output;
+        for (size_t length = 0; length < blob.size(); length++) {
+            if (DecompressBlob(std::string_view(blob).substr(0, length), output)) {
+                ReportFailure(__FILE__, __LINE__, "accepted a blob truncated to " + std::to_string(length) + " of " +
+                                                      std::to_string(blob.size()) + " bytes");
+                break;
+            }
+        }
+    }
+    std::string output;
+    CHECK(!DecompressBlob("PDLZ", output));
+    CHECK(!DecompressBlob(std::string("XDLZ\0\0\0\0\0\0\0\0\0", 13), output));
+}
+
+// Un bit cambiado puede dar otro contenido del tamaño declarado (el formato no lleva suma propia): lo
+// que no puede pasar es leer o escribir fuera de los buffers ni devolver un tamaño distinto del declarado.
+// El hash del manifiesto es quien rechaza ese contenido (ver DamagedBlobIsRejected).
+PDA_TEST(BackupStore, SurvivesBitFlips) {
+    std::mt19937_64 rng(11);
+    for (const auto& input : {PresetLikeJson(rng, 20000), RandomBytes(rng, 2000)}) {
+        std::string blob = CompressBlob(input);
+        std::string output;
+        for (size_t i = 0; i < blob.size(); i++) {
+            std::string damaged = blob;
+            damaged[i] = static_cast<char>(damaged[i] ^ (1 << (i % 8)));
+            if (DecompressBlob(damaged, output) && output.size() != input.size()) {
+                ReportFailure(__FILE__, __LINE__, "flip at byte " + std::to_string(i) + " changed the decoded size");
+                break;
+            }
+        }
+    }
+}
+
+// ----- Almacén: guardar, manifiesto y lectura -----
+
+PDA_TEST(BackupStore, StoreThenLoadThroughManifest) {
+    ScratchDir scratch("BackupStore_Load");
+    AsyncLog noLog;
+    for (bool compress : {true, false}) {
+        BackupStore store = MakeStore(scratch, 10, compress);
+        fs::remove_all(store.root);
+        std::string content = VersionContent(compress ? 1 : 2);
+        CHECK(StoreBackupSnapshot(store, "backup", content, noLog));
+
+        BackupStoreManifest manifest;
+        CHECK(LoadBackupStoreManifest(store, manifest));
+        CHECK_EQ(manifest.entries.size(), size_t{1});
+        if (manifest.entries.empty()) continue;
+
+        const BackupStoreEntry& entry = manifest.entries.front();
+        CHECK_EQ(entry.kind, std::string("backup"));
+        CHECK_EQ(entry.sequence, uint64_t{1});
+        CHECK_EQ(entry.size, static_cast<uintmax_t>(content.size()));
+        CHECK_EQ(entry.compressed, compress);
+        CHECK(fs::exists(BackupBlobPath(store, entry)));
+
+        std::string loaded;
+        CHECK(LoadBackupSnapshot(store, entry, loaded));
+        CHECK_EQ(loaded, content);
+    }
+}
+
+PDA_TEST(BackupStore, IncompressibleContentIsStoredPlain) {
+    ScratchDir scratch("BackupStore_Plain");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 10, true);
+    std::mt19937_64 rng(3);
+    std::string content = RandomBytes(rng, 4096);
+    CHECK(StoreBackupSnapshot(store, "rejected", content, noLog));
+
+    BackupStoreManifest manifest;
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    CHECK_EQ(manifest.entries.size(), size_t{1});
+    if (manifest.entries.empty()) return;
+    CHECK(!manifest.entries.front().compressed);
+    std::string loaded;
+    CHECK(LoadBackupSnapshot(store, manifest.entries.front(), loaded));
+    CHECK(loaded == content);
+}
+
+PDA_TEST(BackupStore, IdenticalContentSharesOneBlob) {
+    ScratchDir scratch("BackupStore_Dedup");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 10, true);
+    std::string content = VersionContent(1);
+    CHECK(StoreBackupSnapshot(store, "backup", content, noLog));
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(2), noLog));
+    // Repetir un contenido lo convierte en la versión más reciente de su tipo, sin duplicarla
+    CHECK(StoreBackupSnapshot(store, "backup", content, noLog));
+    CHECK(StoreBackupSnapshot(store, "corrupted", content, noLog));
+
+    BackupStoreManifest manifest;
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    auto backups = EntriesOfKind(manifest, "backup");
+    CHECK_EQ(backups.size(), size_t{2});
+    CHECK_EQ(EntriesOfKind(manifest, "corrupted").size(), size_t{1});
+    if (backups.size() == 2) {
+        CHECK_EQ(backups.back().hash, HashBytes(content));
+        CHECK_EQ(backups.back().sequence, uint64_t{3});
+    }
+    CHECK_EQ(manifest.nextSequence, uint64_t{5});
+    CHECK_EQ(CountBlobs(store), size_t{2});
+}
+
+PDA_TEST(BackupStore, RetentionKeepsNewestVersionsPerKind) {
+    ScratchDir scratch("BackupStore_Retention");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 2, true);
+
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(1), noLog));
+    CHECK(StoreBackupSnapshot(store, "corrupted", VersionContent(1), noLog));
+    for (int version = 2; version <= 4; version++) {
+        CHECK(StoreBackupSnapshot(store, "backup", VersionContent(version), noLog));
+    }
+
+    BackupStoreManifest manifest;
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    auto backups = EntriesOfKind(manifest, "backup");
+    CHECK_EQ(backups.size(), size_t{2});
+    if (backups.size() == 2) {
+        CHECK_EQ(backups[0].hash, HashBytes(VersionContent(3)));
+        CHECK_EQ(backups[1].hash, HashBytes(VersionContent(4)));
+    }
+
+    // La versión 1 sigue viva como "corrupted" (su blob no se borra); la 2 ya no la usa nadie
+    auto corrupted = EntriesOfKind(manifest, "corrupted");
+    CHECK_EQ(corrupted.size(), size_t{1});
+    std::string loaded;
+    if (!corrupted.empty()) {
+        CHECK(LoadBackupSnapshot(store, corrupted.front(), loaded));
+        CHECK_EQ(loaded, VersionContent(1));
+    }
+    CHECK_EQ(CountBlobs(store), size_t{3});
+
+    for (const auto& entry : backups) {
+        CHECK(LoadBackupSnapshot(store, entry, loaded));
+    }
+}
+
+PDA_TEST(BackupStore, RetentionNeverRemovesUnlistedFiles) {
+    ScratchDir scratch("BackupStore_Unlisted");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 1, true);
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(1), noLog));
+    WriteFileBytes(store.root / "objects" / "0123456789abcdef.lz", "not listed in the manifest");
+
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(2), noLog));
+    CHECK(fs::exists(store.root / "objects" / "0123456789abcdef.lz"));
+    CHECK_EQ(CountBlobs(store), size_t{2});
+}
+
+PDA_TEST(BackupStore, DamagedBlobIsRejected) {
+    ScratchDir scratch("BackupStore_Damaged");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 10, true);
+    std::mt19937_64 rng(13);
+    std::string content = PresetLikeJson(rng, 6000);
+    CHECK(StoreBackupSnapshot(store, "backup", content, noLog));
+
+    BackupStoreManifest manifest;
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    if (manifest.entries.empty()) return;
+    const BackupStoreEntry& entry = manifest.entries.front();
+    fs::path blobPath = BackupBlobPath(store, entry);
+    std::string blob = ReadFileBytes(blobPath);
+
+    // Cada byte dañado: o el blob da exactamente el contenido guardado, o LoadBackupSnapshot lo rechaza
+    std::string loaded;
+    std::string decoded;
+    for (size_t i = 0; i < blob.size(); i += 3) {
+        std::string damaged = blob;
+        damaged[i] = static_cast<char>(damaged[i] ^ (1 << (i % 8)));
+        WriteFileBytes(blobPath, damaged);
+        bool identical = DecompressBlob(damaged, decoded) && decoded == content;
+        if (LoadBackupSnapshot(store, entry, loaded) != identical) {
+            ReportFailure(__FILE__, __LINE__, "damaged byte " + std::to_string(i) + " was not rejected");
+            break;
+        }
+    }
+
+    WriteFileBytes(blobPath, std::string_view(blob).substr(0, blob.size() / 2));
+    CHECK(!LoadBackupSnapshot(store, entry, loaded));
+    fs::remove(blobPath);
+    CHECK(!LoadBackupSnapshot(store, entry, loaded));
+}
+
+// Un manifiesto ilegible se aparta sin sustituirlo y todos los blobs se conservan
+PDA_TEST(BackupStore, UnreadableManifestKeepsHistory) {
+    ScratchDir scratch("BackupStore_BadManifest");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 10, true);
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(1), noLog));
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(2), noLog));
+
+    fs::path manifestPath = store.root / "manifest.ini";
+    std::string original = ReadFileBytes(manifestPath);
+    std::string wrongVersion = original;
+    size_t version = wrongVersion.find("Version = 1");
+    CHECK(version != std::string::npos);
+    if (version == std::string::npos) return;
+    wrongVersion.replace(version, 11, "Version = 0");
+    WriteFileBytes(manifestPath, wrongVersion);
+
+    CHECK(!StoreBackupSnapshot(store, "backup", VersionContent(3), noLog));
+    CHECK(!fs::exists(manifestPath));
+    CHECK_EQ(ReadFileBytes(store.root / "manifest.ini.bad"), wrongVersion);
+    CHECK_EQ(CountBlobs(store), size_t{2});
+
+    // La siguiente ejecución empieza un manifiesto nuevo sin borrar los blobs anteriores
+    CHECK(StoreBackupSnapshot(store, "backup", VersionContent(3), noLog));
+    BackupStoreManifest manifest;
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    CHECK_EQ(manifest.entries.size(), size_t{1});
+    CHECK_EQ(CountBlobs(store), size_t{3});
+
+    // Con el manifiesto apartado restaurado, las versiones antiguas siguen siendo legibles
+    WriteFileBytes(manifestPath, original);
+    CHECK(LoadBackupStoreManifest(store, manifest));
+    CHECK_EQ(manifest.entries.size(), size_t{2});
+    std::string loaded;
+    for (const auto& entry : manifest.entries) {
+        CHECK(LoadBackupSnapshot(store, entry, loaded));
+    }
+}
+
+// Si el archivo temporal no se puede escribir, el JSON en disco no se tocó: no es una versión dañada y no
+// ocupa sitio en el almacén
+PDA_TEST(BackupStore, FailedJsonWriteKeepsOriginalOutOfAnalysis) {
+    ScratchDir scratch("BackupStore_FailedWrite");
+    AsyncLog noLog;
+    BackupStore store = MakeStore(scratch, 10, true);
+    std::string original = ReadFileBytes(FixturePath("escaped_names/before.json"));
+    std::string updated = ReadFileBytes(FixturePath("escaped_names/after.json"));
+    fs::path jsonPath = scratch.path / "OBody_presetDistributionConfig.json";
+    WriteFileBytes(jsonPath, original);
+
+    fs::path tempPath = jsonPath;
+    tempPath.replace_extension(".tmp");
+    fs::create_directories(tempPath / "blocked");
+
+    WrittenContent written;
+    CHECK(!WriteJsonAtomically(jsonPath, updated, store, written, noLog));
+    CHECK(!written.known);
+    CHECK_EQ(ReadFileBytes(jsonPath), original);
+    CHECK(!fs::exists(store.root / "manifest.ini"));
+    CHECK_EQ(CountBlobs(store), size_t{0});
+
+    fs::remove_all(tempPath);
+    CHECK(WriteJsonAtomically(jsonPath, updated, store, written, noLog));
+    CHECK(written.known);
+    CHECK_EQ(ReadFileBytes(jsonPath), updated);
+    CHECK_EQ(CountBlobs(store), size_t{0});
+}
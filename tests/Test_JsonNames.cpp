@@ -0,0 +1,60 @@
+#include "tests/PDA_Test.h"
+
+// ===== NOMBRES CON ESCAPES EN EL JSON =====
+// Los nombres se guardan decodificados y se vuelven a escribir en la forma escapada canónica: los
+// escapes no se duplican en cada ejecución y los caracteres no ASCII salen en UTF-8 tal cual.
+
+namespace {
+const char* const kNamesConfigIni =
+    "[Original backup]\nBackup = 0\n\n[Run cache]\nForceRun = true\n\n[Formatting]\nRepair = 0\n";
+}
+
+PDA_TEST(JsonNames, UnescapeDecodesEveryEscape) {
+    CHECK_EQ(UnescapeJson(R"(q\"b\\s\/)"), std::string("q\"b\\s/"));
+    CHECK_EQ(UnescapeJson(R"(\b\f\n\r\t)"), std::string("\b\f\n\r\t"));
+    CHECK_EQ(UnescapeJson(R"(\u00dcn\u00EFc)"), std::string("\xC3\x9Cn\xC3\xAF" "c"));
+    CHECK_EQ(UnescapeJson(R"(\u20ac)"), std::string("\xE2\x82\xAC"));
+    // Par sustituto UTF-16 -> un único carácter de 4 bytes
+    CHECK_EQ(UnescapeJson(R"(\ud83d\ude00)"), std::string("\xF0\x9F\x98\x80"));
+}
+
+PDA_TEST(JsonNames, UnescapeKeepsInvalidEscapesLiteral) {
+    CHECK_EQ(UnescapeJson(R"(\u12)"), std::string(R"(\u12)"));
+    CHECK_EQ(UnescapeJson(R"(\x41)"), std::string(R"(\x41)"));
+    CHECK_EQ(UnescapeJson("end\\"), std::string("end\\"));
+}
+
+PDA_TEST(JsonNames, EscapeKeepsUtf8AndEscapesControls) {
+    CHECK_EQ(EscapeJson("Mod \xC3\x9Cn\xC3\xAF" "c.esp"), std::string("Mod \xC3\x9Cn\xC3\xAF" "c.esp"));
+    CHECK_EQ(EscapeJson("a\"b\\c\td"), std::string(R"(a\"b\\c\td)"));
+    CHECK_EQ(EscapeJson(std::string_view("\x01\x1f", 2)), std::string(R"(\u0001\u001f)"));
+    CHECK_EQ(EscapeJson("Sl/ash"), std::string("Sl/ash"));
+}
+
+PDA_TEST(JsonNames, EscapeUnescapeRoundTrip) {
+    const std::string names[] = {"Plain_000001.esp", "Mod \"Quoted\"", "Back\\slash\\", "Tab\tbed",
+                                 "Mod \xC3\x9Cn\xC3\xAF" "c\xC3\xB6" "d\xC3\xA9", "\xF0\x9F\x98\x80 Emoji",
+                                 std::string("Nul\0Byte", 8)};
+    for (const auto& name : names) {
+        CHECK_EQ(UnescapeJson(EscapeJson(name)), name);
+    }
+}
+
+// before.json -> after.json con OBodyNG_PDA_Escapes.ini: las reglas escritas en texto plano encuentran
+// los plugins escapados del JSON, las secciones modificadas salen en la forma canónica y las que no
+// cambian conservan sus bytes
+PDA_TEST(JsonNames, FixtureRewriteIsCanonicalAndStable) {
+    std::string before = ReadFileBytes(FixturePath("escaped_names/before.json"));
+    std::string expected = ReadFileBytes(FixturePath("escaped_names/after.json"));
+    std::string rules = ReadFileBytes(FixturePath("escaped_names/OBodyNG_PDA_Escapes.ini"));
+    CHECK(!before.empty());
+    CHECK(!expected.empty());
+
+    TestDataDir data("JsonNames", before, kNamesConfigIni, {{"OBodyNG_PDA_Escapes.ini", rules}});
+    CHECK(data.run().success);
+    CHECK_EQ(ReadFileBytes(data.jsonPath()), expected);
+
+    // Una segunda ejecución con las mismas reglas no cambia nada: los escapes no se acumulan
+    CHECK(data.run().success);
+    CHECK_EQ(ReadFileBytes(data.jsonPath()), expected);
+}
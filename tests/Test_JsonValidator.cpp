@@ -0,0 +1,126 @@
+#include "tests/PDA_Test.h"
+
+// ===== VALIDADOR JSON DE UNA PASADA =====
+// Fija el mensaje, el byte, la línea y la columna del primer error de cada tipo, las dos tolerancias de
+// siempre (comas finales y cadenas que no son UTF-8) y el rechazo intencionado de raíces que no son
+// objetos.
+
+namespace {
+struct InvalidCase {
+    const char* json;
+    const char* error;
+    size_t offset;
+    size_t line;
+    size_t column;
+};
+
+void CheckInvalid(const InvalidCase& invalid) {
+    JsonValidationResult result = ValidateJson(invalid.json);
+    CHECK(!result.valid);
+    CHECK_EQ(result.error, std::string(invalid.error));
+    CHECK_EQ(result.errorOffset, invalid.offset);
+    CHECK_EQ(result.errorLine, invalid.line);
+    CHECK_EQ(result.errorColumn, invalid.column);
+}
+}  // namespace
+
+PDA_TEST(JsonValidator, RejectsNonObjectRoots) {
+    const InvalidCase cases[] = {
+        {"", "JSON root must be an object", 0, 1, 1},
+        {"[1, 2]", "JSON root must be an object", 0, 1, 1},
+        {"  \n  \"text\"", "JSON root must be an object", 5, 2, 3},
+        {"null", "JSON root must be an object", 0, 1, 1},
+        {"42", "JSON root must be an object", 0, 1, 1},
+    };
+    for (const auto& invalid : cases) CheckInvalid(invalid);
+}
+
+PDA_TEST(JsonValidator, PinsStructureErrors) {
+    const InvalidCase cases[] = {
+        {R"({"a": 1,, "b": 2})", "Unexpected ',' (double comma)", 8, 1, 9},
+        {"{\n    \"npc\" {}\n}", "Expected ':' after object key", 12, 2, 11},
+        {R"({1: 2})", "Expected a string key or '}'", 1, 1, 2},
+        {R"({"a": })", "Expected a value", 6, 1, 7},
+        {R"({"a": [1 2]})", "Expected ',' or ']' after array element", 9, 1, 10},
+        {R"({"a": 01})", "Expected ',' or '}' after object member", 7, 1, 8},
+        {R"({"a": [1})", "Mismatched '}' (expected ']')", 8, 1, 9},
+        {R"({"a": {"b": 1]})", "Mismatched ']' (expected '}')", 13, 1, 14},
+        {"{\"a\": [1, 2]\n", "Unexpected end of JSON (unclosed object or array)", 13, 2, 1},
+        {R"({} {})", "Unexpected data after the end of the root object", 3, 1, 4},
+    };
+    for (const auto& invalid : cases) CheckInvalid(invalid);
+}
+
+PDA_TEST(JsonValidator, PinsStringErrors) {
+    const InvalidCase cases[] = {
+        {"{\n  \"a\": \"x\\q\"\n}", "Invalid escape sequence in string", 11, 2, 10},
+        {R"({"a": "\u12G4"})", "Invalid \\u escape in string (expected 4 hex digits)", 7, 1, 8},
+        {"{\"a\": \"x\ty\"}", "Unescaped control character in string", 8, 1, 9},
+        {R"({"a": "abc)", "Unterminated string", 6, 1, 7},
+        {R"({"a": "abc\)", "Unterminated string", 6, 1, 7},
+    };
+    for (const auto& invalid : cases) CheckInvalid(invalid);
+}
+
+PDA_TEST(JsonValidator, PinsNumberAndLiteralErrors) {
+    const InvalidCase cases[] = {
+        {R"({"a": -})", "Invalid number", 6, 1, 7},
+        {R"({"a": 1.})", "Invalid number (digits expected after '.')", 6, 1, 7},
+        {R"({"a": 1e+})", "Invalid number (digits expected in exponent)", 6, 1, 7},
+        {R"({"a": tru})", "Invalid literal (expected true, false or null)", 6, 1, 7},
+    };
+    for (const auto& invalid : cases) CheckInvalid(invalid);
+}
+
+// Las líneas se cuentan por '\n' y las columnas en bytes, así que un '\r' de CRLF no cuenta como línea
+PDA_TEST(JsonValidator, CountsLinesAndColumnsInBytes) {
+    CheckInvalid({"{\r\n\"a\": x}", "Expected a value", 8, 2, 6});
+    CheckInvalid({"{\"\xC3\x9C\": \"\xC3\xA9\",\n \"b\": }", "Expected a value", 19, 2, 7});
+    // Sólo se informa el primer error
+    CheckInvalid({R"({"a": 1,, "b": })", "Unexpected ',' (double comma)", 8, 1, 9});
+}
+
+PDA_TEST(JsonValidator, AcceptsTheFullGrammar) {
+    const char* const documents[] = {
+        "{}",
+        " \r\n\t{ } \n",
+        R"({"a": "\"\\\/\b\f\n\r\t\u00e9\uD83D\uDE00 é"})",
+        R"({"n": [0, -0, 12, -3.25, 1e10, 2E-3, -0.5e+10], "l": [true, false, null], "o": {"x": {"y": []}}})",
+        // El contenido de las cadenas no se valida como UTF-8
+        "{\"a\": \"\xff\xfe\"}",
+    };
+    for (const char* document : documents) {
+        JsonValidationResult result = ValidateJson(document);
+        CHECK(result.valid);
+        CHECK_EQ(result.error, std::string());
+        CHECK_EQ(result.trailingCommas, size_t{0});
+    }
+}
+
+PDA_TEST(JsonValidator, ToleratesTrailingCommasWithCount) {
+    JsonValidationResult result = ValidateJson(R"({"a": [1, 2,], "b": {"c": 1,},})");
+    CHECK(result.valid);
+    CHECK_EQ(result.trailingCommas, size_t{3});
+    CHECK_EQ(result.firstTrailingComma, size_t{11});
+
+    // Una coma final no sustituye a un valor: "[,]" sigue siendo un error
+    CheckInvalid({R"({"a": [,]})", "Unexpected ',' (double comma)", 7, 1, 8});
+}
+
+PDA_TEST(JsonValidator, IndexesRootMembers) {
+    std::string_view json = R"({"npc": {}, "x": [1], "s": "v"})";
+    JsonValidationResult result = ValidateJson(json);
+    CHECK(result.valid);
+    CHECK_EQ(result.sections.sections.size(), size_t{3});
+    if (result.sections.sections.size() != 3) return;
+
+    const JsonSectionSpan* npc = result.sections.find("npc");
+    CHECK(npc != nullptr);
+    if (npc != nullptr) CHECK_EQ(json.substr(npc->valueStart, npc->valueEnd - npc->valueStart), "{}");
+    const JsonSectionSpan* x = result.sections.find("x");
+    CHECK(x != nullptr);
+    if (x != nullptr) CHECK_EQ(json.substr(x->valueStart, x->valueEnd - x->valueStart), "[1]");
+    const JsonSectionSpan* s = result.sections.find("s");
+    CHECK(s != nullptr);
+    if (s != nullptr) CHECK_EQ(json.substr(s->valueStart, s->valueEnd - s->valueStart), "\"v\"");
+}
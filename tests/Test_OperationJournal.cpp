@@ -0,0 +1,119 @@
+#include "tests/PDA_Test.h"
+
+// ===== DIARIO DE OPERACIONES: --undo Y --replay =====
+// Dos ejecuciones reales del pipeline sobre el fixture de nombres escapados; el JSON reconstruido antes y
+// después de cada una debe coincidir byte a byte con el que había en disco en ese momento, con y sin
+// almacén de backups.
+
+namespace {
+const char* const kSecondRules =
+    "npcPluginMale = Mod \"Quoted\".esp|!Sl/ash Preset|-\n"
+    "npcPluginFemale = Mod\\Back\\slash.esp|Preset Added|*\n"
+    "raceMale = Second Race.esp|Preset Two\n";
+
+std::string JournalConfigIni(bool backup) {
+    return std::string("[Original backup]\nBackup = ") + (backup ? "1" : "0") +
+           "\n\n[Run cache]\nForceRun = true\n\n[Formatting]\nRepair = 0\n";
+}
+
+// Estado del JSON en disco antes de cada ejecución y al final
+struct JournalFixture {
+    explicit JournalFixture(std::string_view name, bool backup)
+        : data(name, ReadFileBytes(FixturePath("escaped_names/before.json")), JournalConfigIni(backup),
+               {{"OBodyNG_PDA_Escapes.ini", ReadFileBytes(FixturePath("escaped_names/OBodyNG_PDA_Escapes.ini"))}}) {
+        states.push_back(ReadFileBytes(data.jsonPath()));
+        CHECK(data.run().success);
+        states.push_back(ReadFileBytes(data.jsonPath()));
+
+        WriteFileBytes(data.scratch.path / "OBodyNG_PDA_Second.ini", kSecondRules);
+        CHECK(data.run().success);
+        states.push_back(ReadFileBytes(data.jsonPath()));
+    }
+
+    fs::path journalPath() const { return data.pluginsPath() / "Backup_OBody_DPA" / "OperationJournal.log"; }
+
+    TestDataDir data;
+    std::vector<std::string> states;
+};
+
+// Devuelve la base usada, o "" si no se pudo reconstruir
+std::string Rebuild(const JournalFixture& fixture, uint64_t runId, bool beforeRun, std::string& result) {
+    NameTable names;
+    std::vector<JournalRun> runs;
+    if (!LoadOperationJournal(fixture.journalPath(), names, runs)) return "";
+    for (const auto& run : runs) {
+        if (run.id != runId) continue;
+        std::string source;
+        std::string error;
+        if (!RebuildJournalState(fixture.data.pluginsPath(), runs, run, beforeRun, names, result, source, error)) {
+            return "";
+        }
+        return source;
+    }
+    return "";
+}
+}  // namespace
+
+PDA_TEST(OperationJournal, RecordsOneRunPerChange) {
+    JournalFixture fixture("OperationJournal", false);
+    CHECK(fixture.states[0] != fixture.states[1]);
+    CHECK(fixture.states[1] != fixture.states[2]);
+
+    NameTable names;
+    std::vector<JournalRun> runs;
+    CHECK(LoadOperationJournal(fixture.journalPath(), names, runs));
+    CHECK_EQ(runs.size(), size_t{2});
+    if (runs.size() != 2) return;
+    CHECK_EQ(runs[0].fromHash, HashBytes(fixture.states[0]));
+    CHECK_EQ(runs[0].toHash, HashBytes(fixture.states[1]));
+    CHECK_EQ(runs[1].fromHash, HashBytes(fixture.states[1]));
+    CHECK_EQ(runs[1].toHash, HashBytes(fixture.states[2]));
+
+    // La segunda ejecución asigna, quita un preset y quita un plugin entero
+    bool removesPlugin = false;
+    for (const auto& op : runs[1].ops) removesPlugin = removesPlugin || op.removePlugin;
+    CHECK(removesPlugin);
+}
+
+// Con Backup = 1 la primera ejecución guarda el JSON original en el almacén; la segunda ya no guarda nada,
+// así que deshacer o rehacer la segunda obliga a encadenar el diario desde esa versión
+PDA_TEST(OperationJournal, UndoAndReplayFromBackupStore) {
+    JournalFixture fixture("OperationJournal", true);
+    const std::vector<std::string>& states = fixture.states;
+
+    for (uint64_t runId = 1; runId <= 2; runId++) {
+        std::string undone;
+        CHECK_EQ(Rebuild(fixture, runId, true, undone), std::string("backup store version #1"));
+        CHECK_EQ(undone, states[runId - 1]);
+
+        std::string replayed;
+        CHECK_EQ(Rebuild(fixture, runId, false, replayed), std::string("backup store version #1"));
+        CHECK_EQ(replayed, states[runId]);
+    }
+}
+
+// Sin almacén sólo queda el JSON actual como base: rehacer la última ejecución funciona y deshacer no
+// puede, porque el diario sólo avanza. Una copia literal anterior al almacén vuelve a hacerlo posible.
+PDA_TEST(OperationJournal, UndoAndReplayWithoutBackupStore) {
+    JournalFixture fixture("OperationJournal", false);
+    const std::vector<std::string>& states = fixture.states;
+    CHECK(!fs::exists(fixture.data.pluginsPath() / "Backup_OBody_DPA" / "Store"));
+
+    std::string replayed;
+    CHECK_EQ(Rebuild(fixture, 2, false, replayed), std::string("current JSON"));
+    CHECK_EQ(replayed, states[2]);
+
+    std::string undone;
+    CHECK_EQ(Rebuild(fixture, 1, true, undone), std::string());
+    CHECK_EQ(Rebuild(fixture, 2, true, undone), std::string());
+
+    WriteFileBytes(fixture.data.pluginsPath() / "Backup_OBody_DPA" / "OBody_presetDistributionConfig.json",
+                   states[0]);
+    for (uint64_t runId = 1; runId <= 2; runId++) {
+        CHECK_EQ(Rebuild(fixture, runId, true, undone), std::string("literal backup"));
+        CHECK_EQ(undone, states[runId - 1]);
+
+        CHECK_EQ(Rebuild(fixture, runId, false, replayed), std::string("literal backup"));
+        CHECK_EQ(replayed, states[runId]);
+    }
+}
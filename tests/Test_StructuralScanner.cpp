@@ -0,0 +1,110 @@
+#include <random>
+
+#include "core/PDA_StructuralScanner.h"
+#include "tests/PDA_Test.h"
+
+// ===== EQUIVALENCIA DE LOS KERNELS DEL ESCÁNER ESTRUCTURAL =====
+// Todos los kernels disponibles en esta CPU deben dar el mismo índice que una referencia byte a byte,
+// en especial con escapes que cruzan el límite de un bloque de 64 bytes y con bloques finales parciales.
+
+namespace {
+const StructuralKernel kAllKernels[] = {StructuralKernel::Scalar, StructuralKernel::Sse2, StructuralKernel::Avx2};
+
+// La definición del índice, sin bloques ni máscaras
+JsonStructuralIndex ReferenceScan(std::string_view json) {
+    JsonStructuralIndex index;
+    bool inString = false;
+    bool escaped = false;
+    for (size_t i = 0; i < json.size(); i++) {
+        char c = json[i];
+        if (escaped) {
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '"') {
+            index.positions.push_back(static_cast<uint32_t>(i));
+            inString = !inString;
+        } else if (!inString && std::string_view("{}[]():,").find(c) != std::string_view::npos) {
+            index.positions.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    index.unterminatedString = inString;
+    return index;
+}
+
+// Devuelve false (y anota el fallo) en la primera discrepancia, para no inundar la salida
+bool CheckAllKernels(std::string_view json, const std::string& label) {
+    JsonStructuralIndex expected = ReferenceScan(json);
+    for (StructuralKernel kernel : kAllKernels) {
+        if (!StructuralKernelSupported(kernel)) continue;
+
+        JsonStructuralIndex actual = ScanJsonStructure(json, kernel);
+        if (actual.positions != expected.positions || actual.unterminatedString != expected.unterminatedString) {
+            ReportFailure(__FILE__, __LINE__,
+                          std::string(StructuralKernelName(kernel)) + " kernel differs from the reference on " +
+                              label + " (" + std::to_string(json.size()) + " bytes)");
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+PDA_TEST(StructuralScanner, ScalarKernelIsAlwaysSupported) {
+    CHECK(StructuralKernelSupported(StructuralKernel::Scalar));
+    CHECK(StructuralKernelSupported(ActiveStructuralKernel()));
+}
+
+PDA_TEST(StructuralScanner, SmallDocuments) {
+    const char* const documents[] = {"",
+                                     "{}",
+                                     R"({"a": [1, 2], "b": {"c": "x,y:z"}})",
+                                     R"json({"esc\"aped": "\\", "paren": "(x)"} (1))json",
+                                     R"("unterminated \" string)",
+                                     R"(\"outside\" {"k": "v"})",
+                                     "{\"trailing backslash\": \"x\\"};
+    for (const char* document : documents) {
+        CheckAllKernels(document, std::string("\"") + document + "\"");
+    }
+}
+
+// Rachas de barras invertidas de 1 a 70 bytes que empiezan a ambos lados de los límites de 64 y 128:
+// la paridad de la racha decide si la comilla que la sigue cierra la cadena
+PDA_TEST(StructuralScanner, EscapeRunsAcrossBlockBoundaries) {
+    const std::string prefix = R"({"key": [{"name": "value", "x": ")";
+    for (size_t start = 40; start <= 140; start++) {
+        for (size_t run = 1; run <= 70; run++) {
+            std::string json = prefix;
+            while (json.size() < start) json += (json.size() % 7 == 0) ? ' ' : 'a';
+            json.append(run, '\\');
+            json += R"json(", "y": [1, {"z": "(\")"}]}, ":"])json";
+            if (!CheckAllKernels(json, "run of " + std::to_string(run) + " at " + std::to_string(start))) return;
+        }
+    }
+}
+
+// Textos aleatorios (semilla fija) de un alfabeto casi sólo de caracteres con significado, con bytes
+// >= 0x80 para detectar comparaciones con signo
+PDA_TEST(StructuralScanner, RandomInputsMatchReference) {
+    const char alphabet[] = {'\\', '\\', '\\', '"', '"', '{', '}', '[', ']', '(', ')', ':', ',', 'a', ' ', '\n',
+                             '\x80', '\xdb', '\xfb', '\xa8', '\x00'};
+    std::mt19937_64 rng(19);
+    for (int iteration = 0; iteration < 4000; iteration++) {
+        size_t length = rng() % 400;
+        std::string json;
+        json.reserve(length);
+        for (size_t i = 0; i < length; i++) {
+            json += alphabet[rng() % sizeof(alphabet)];
+        }
+        if (!CheckAllKernels(json, "random input #" + std::to_string(iteration))) return;
+    }
+}
+
+PDA_TEST(StructuralScanner, FixtureDocumentMatchesReference) {
+    std::string json = ReadFileBytes(FixturePath("escaped_names/before.json"));
+    CHECK(!json.empty());
+    std::string large;
+    while (large.size() < 256 * 1024) large += json;
+    CheckAllKernels(json, "escaped_names/before.json");
+    CheckAllKernels(large, "repeated escaped_names/before.json");
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "core/PDA_Core.h"
+#include "core/PDA_StructuralScanner.h"
+
+// ===== BENCHMARK POR ETAPAS DEL PIPELINE =====
+// Mide cada etapa de una ejecución completa sobre una copia del JSON de <DataDir> en una carpeta de
+// trabajo, de modo que el original y los OBodyNG_PDA_*.ini nunca se modifican (los contadores de las
+// reglas no se actualizan). El JSON de trabajo se restaura antes de cada iteración.
+
+struct StageTimings {
+    std::string name;
+    std::vector<double> milliseconds;
+};
+
+template <typename Func>
+bool TimeStage(StageTimings& stage, Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = func();
+    auto end = std::chrono::steady_clock::now();
+    stage.milliseconds.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    return ok;
+}
+
+void PrintUsage() {
+    std::cout << "Usage: PDA_Bench <DataDir> [--iterations <N>] [--work <dir>] [--log <logFile>]" << std::endl;
+    std::cout << "  Times each pipeline stage on a copy of <DataDir>/SKSE/Plugins/OBody_presetDistributionConfig.json"
+              << std::endl;
+    std::cout << "  using the OBodyNG_PDA_*.ini rules in <DataDir>. Logging is discarded unless --log is given."
+              << std::endl;
+}
+
+bool WriteBenchFile(const fs::path& filePath, const std::string& content) {
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return file.good();
+}
+
+void PrintStageTable(const std::vector<StageTimings>& stages) {
+    std::cout << std::left << std::setw(28) << "Stage" << std::right << std::setw(12) << "min ms" << std::setw(12)
+              << "median ms" << std::setw(12) << "mean ms" << std::setw(12) << "max ms" << std::endl;
+    std::cout << std::string(76, '-') << std::endl;
+
+    for (const auto& stage : stages) {
+        if (stage.milliseconds.empty()) continue;
+        std::vector<double> sorted = stage.milliseconds;
+        std::sort(sorted.begin(), sorted.end());
+        double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+        double median = sorted[sorted.size() / 2];
+
+        std::cout << std::left << std::setw(28) << stage.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << sorted.front() << std::setw(12) << median << std::setw(12) << mean
+                  << std::setw(12) << sorted.back() << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        fs::path dataPath;
+        fs::path workDir = fs::temp_directory_path() / "PDA_Bench";
+        fs::path logFilePath;
+        int iterations = 10;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--iterations" && i + 1 < argc) {
+                iterations = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--work" && i + 1 < argc) {
+                workDir = argv[++i];
+            } else if (arg == "--log" && i + 1 < argc) {
+                logFilePath = argv[++i];
+            } else if (arg == "--help" || arg == "-h") {
+                PrintUsage();
+                return 0;
+            } else if (dataPath.empty()) {
+                dataPath = arg;
+            } else {
+                PrintUsage();
+                return 2;
+            }
+        }
+
+        fs::path sourceJsonPath = dataPath / "SKSE" / "Plugins" / "OBody_presetDistributionConfig.json";
+        if (dataPath.empty() || !fs::exists(sourceJsonPath)) {
+            std::cerr << "ERROR: JSON not found: " << sourceJsonPath.string() << std::endl;
+            PrintUsage();
+            return 2;
+        }
+
+        // Sin --log el log queda cerrado y todas las escrituras se descartan
+        AsyncLog logFile;
+        if (!logFilePath.empty()) {
+            logFile.open(logFilePath);
+        }
+
+        std::string pristineJson;
+        if (!LoadJsonFile(sourceJsonPath, pristineJson, logFile)) {
+            std::cerr << "ERROR: Could not read " << sourceJsonPath.string() << std::endl;
+            return 1;
+        }
+
+        CreateDirectoryIfNotExists(workDir);
+        fs::path workJsonPath = workDir / "OBody_presetDistributionConfig.json";
+        BackupStore backupStore;
+        backupStore.root = workDir / "Store";
+
+        std::vector<fs::path> ruleFilePaths = CollectRuleFilePaths(dataPath, logFile);
+        const RuleKeySet& validKeys = GetValidRuleKeys();
+
+        std::vector<StageTimings> stages = {{"LoadJsonFile", {}},
+                                            {"ScanJsonStructure", {}},
+                                            {"integrity check", {}},
+                                            {"ValidateJson", {}},
+                                            {"ReadCompleteJson", {}},
+                                            {"rule ingest", {}},
+                                            {"rule apply", {}},
+                                            {"CheckIfChangesNeeded", {}},
+                                            {"SerializeSections", {}},
+                                            {"PreserveOriginalSections", {}},
+                                            {"WriteJsonAtomically", {}},
+                                            {"CorrectJsonIndentation", {}}};
+        enum Stage { kLoad, kScan, kIntegrity, kValidate, kRead, kIngest, kApply, kCheck, kSerialize, kPreserve, kWrite, kIndent };
+
+        std::cout << "JSON: " << sourceJsonPath.string() << " (" << pristineJson.size() << " bytes)" << std::endl;
+        std::cout << "Rule files: " << ruleFilePaths.size() << " | Iterations: " << iterations << std::endl;
+        std::cout << "Structural scanner: " << StructuralKernelName(ActiveStructuralKernel()) << std::endl;
+        std::cout << "Work directory: " << workDir.string() << std::endl << std::endl;
+
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            if (!WriteBenchFile(workJsonPath, pristineJson)) {
+                std::cerr << "ERROR: Could not write work copy " << workJsonPath.string() << std::endl;
+                return 1;
+            }
+
+            std::string jsonContent;
+            std::map<std::string, OrderedPluginData> processedData;
+            for (const auto& key : validKeys) {
+                processedData[key] = OrderedPluginData();
+            }
+            NameTable names;
+            std::vector<IniRuleFile> ruleFiles;
+            RuleApplyStats ruleStats;
+            SerializedSections sections;
+            JsonSectionIndex sectionIndex;
+            WrittenContent written;
+            bool changesNeeded = false;
+            std::string updatedJsonContent;
+
+            // Como en el plugin, el JSON se lee una vez y el buffer se comparte con las etapas siguientes
+            bool ok = TimeStage(stages[kLoad], [&] { return LoadJsonFile(workJsonPath, jsonContent, logFile); });
+            // El escáner estructural solo, para medir su rendimiento (cada etapa que lo usa lo repite)
+            ok = ok && TimeStage(stages[kScan], [&] { return !ScanJsonStructure(jsonContent).unterminatedString; });
+            ok = ok && TimeStage(stages[kIntegrity],
+                                 [&] { return PerformSimpleJsonIntegrityCheck(workJsonPath, jsonContent, logFile); });
+            // El validador solo (las comprobaciones de integridad y ReadCompleteJson lo usan)
+            ok = ok && TimeStage(stages[kValidate], [&] { return ValidateJson(jsonContent).valid; });
+            ok = ok && TimeStage(stages[kRead], [&] {
+                return ReadCompleteJson(workJsonPath, jsonContent, processedData, names, sectionIndex, logFile);
+            });
+            ok = ok && TimeStage(stages[kIngest], [&] {
+                ruleFiles = IngestRuleFilesParallel(ruleFilePaths, validKeys, names);
+                return true;
+            });
+            ok = ok && TimeStage(stages[kApply], [&] {
+                ApplyRuleFiles(ruleFiles, processedData, names, ruleStats, false, logFile);
+                return true;
+            });
+            ok = ok && TimeStage(stages[kCheck], [&] {
+                changesNeeded = CheckIfChangesNeeded(processedData);
+                return true;
+            });
+            ok = ok && TimeStage(stages[kSerialize], [&] {
+                sections = SerializeSections(processedData, names);
+                return true;
+            });
+            ok = ok && TimeStage(stages[kPreserve], [&] {
+                updatedJsonContent = PreserveOriginalSections(jsonContent, sectionIndex, sections, logFile);
+                return !updatedJsonContent.empty();
+            });
+            ok = ok && TimeStage(stages[kWrite], [&] {
+                return WriteJsonAtomically(workJsonPath, updatedJsonContent, backupStore, written, logFile);
+            });
+            ok = ok && TimeStage(stages[kIndent], [&] {
+                return CorrectJsonIndentation(workJsonPath, updatedJsonContent, backupStore, written, logFile);
+            });
+
+            if (!ok) {
+                std::cerr << "ERROR: A pipeline stage failed in iteration " << (iteration + 1)
+                          << " (run with --log for details)" << std::endl;
+                return 1;
+            }
+
+            if (iteration == 0) {
+                std::cout << "Rules processed: " << ruleStats.rulesProcessed << " | Applied: " << ruleStats.rulesApplied
+                          << " | Changes needed: " << (changesNeeded ? "yes" : "no") << std::endl
+                          << std::endl;
+            }
+        }
+
+        PrintStageTable(stages);
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR in PDA_Bench: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "ERROR in PDA_Bench: Unknown exception" << std::endl;
+        return 1;
+    }
+}
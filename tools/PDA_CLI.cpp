@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "core/PDA_Core.h"
+
+// ===== CLI: EJECUCIÓN COMPLETA FUERA DEL JUEGO =====
+// Ejecuta el mismo pipeline que el plugin en kDataLoaded sobre una carpeta Data cualquiera, para poder
+// perfilar y reproducir ejecuciones sin Skyrim. Los archivos se modifican igual que en el juego.
+
+void PrintUsage() {
+    std::cout << "Usage: PDA_CLI <DataDir> [--log <logFile>]" << std::endl;
+    std::cout << "       PDA_CLI <DataDir> --list-backups" << std::endl;
+    std::cout << "       PDA_CLI <DataDir> --extract-backup <sequence> <outFile>" << std::endl;
+    std::cout << "       PDA_CLI <DataDir> --journal" << std::endl;
+    std::cout << "       PDA_CLI <DataDir> --replay <run> <outFile> | --undo <run> <outFile>" << std::endl;
+    std::cout << "  Runs a full preset distribution pass on <DataDir> (the folder that contains" << std::endl;
+    std::cout << "  SKSE/Plugins/OBody_presetDistributionConfig.json and the OBodyNG_PDA_*.ini files)." << std::endl;
+    std::cout << "  The log defaults to OBody_NG_Preset_Distribution_Assistant-NG.log in the current directory;"
+              << std::endl;
+    std::cout << "  per-stage timings go to a .report.json file next to it." << std::endl;
+    std::cout << "  --list-backups and --extract-backup read the backup store (SKSE/Plugins/Backup_OBody_DPA/Store)"
+              << std::endl;
+    std::cout << "  without running the pipeline; extracted versions are written uncompressed." << std::endl;
+    std::cout << "  --journal lists the runs in the operation journal (SKSE/Plugins/Backup_OBody_DPA/OperationJournal.log);"
+              << std::endl;
+    std::cout << "  --replay rebuilds the JSON as that run left it and --undo as it was before the run, by replaying"
+              << std::endl;
+    std::cout << "  the journal over the newest usable backup. The live JSON is never modified." << std::endl;
+}
+
+// Lista las versiones del almacén o extrae una de ellas (por su número de secuencia) a outFile
+int RunBackupStoreCommand(const fs::path& dataPath, const std::string& sequenceText, const fs::path& outFile) {
+    BackupStore store;
+    store.root = dataPath / "SKSE" / "Plugins" / "Backup_OBody_DPA" / "Store";
+    BackupStoreManifest manifest;
+    if (!LoadBackupStoreManifest(store, manifest)) {
+        std::cerr << "ERROR: No backup store manifest in " << store.root.string() << std::endl;
+        return 1;
+    }
+
+    if (sequenceText.empty()) {
+        for (const auto& entry : manifest.entries) {
+            std::cout << "#" << entry.sequence << "  " << entry.kind << "  " << entry.timestamp << "  " << entry.size
+                      << " bytes  " << BackupBlobPath(store, entry).filename().string() << std::endl;
+        }
+        return 0;
+    }
+
+    for (const auto& entry : manifest.entries) {
+        if (std::to_string(entry.sequence) != sequenceText) continue;
+
+        std::string content;
+        uint64_t checksum = 0;
+        if (!LoadBackupSnapshot(store, entry, content)) {
+            std::cerr << "ERROR: Backup store version #" << entry.sequence << " is missing or damaged" << std::endl;
+            return 1;
+        }
+        if (!WriteFileWithChecksum(outFile, content, checksum)) {
+            std::cerr << "ERROR: Could not write " << outFile.string() << std::endl;
+            return 1;
+        }
+        std::cout << "Extracted " << entry.kind << " version #" << entry.sequence << " (" << content.size()
+                  << " bytes) to " << outFile.string() << std::endl;
+        return 0;
+    }
+
+    std::cerr << "ERROR: No backup store version #" << sequenceText << std::endl;
+    return 1;
+}
+
+std::string HashText(uint64_t hash) {
+    std::ostringstream text;
+    text << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return text.str();
+}
+
+// Lista el diario, o reconstruye en outFile el JSON tras la ejecución runText (--replay) o antes de ella
+// (--undo) con RebuildJournalState
+int RunJournalCommand(const fs::path& dataPath, const std::string& command, const std::string& runText,
+                      const fs::path& outFile) {
+    fs::path pluginsPath = dataPath / "SKSE" / "Plugins";
+    fs::path journalPath = pluginsPath / "Backup_OBody_DPA" / "OperationJournal.log";
+    NameTable names;
+    std::vector<JournalRun> runs;
+    if (!LoadOperationJournal(journalPath, names, runs)) {
+        std::cerr << "ERROR: No operation journal in " << journalPath.string() << std::endl;
+        return 1;
+    }
+
+    if (command == "--journal") {
+        for (const auto& run : runs) {
+            std::cout << "#" << run.id << "  " << run.timestamp << "  " << HashText(run.fromHash) << " -> "
+                      << HashText(run.toHash) << "  " << run.ops.size() << " operations" << std::endl;
+        }
+        return 0;
+    }
+
+    auto run = std::find_if(runs.begin(), runs.end(),
+                            [&](const JournalRun& candidate) { return std::to_string(candidate.id) == runText; });
+    if (run == runs.end()) {
+        std::cerr << "ERROR: No complete journal run #" << runText << std::endl;
+        return 1;
+    }
+    std::string result;
+    std::string source;
+    std::string error;
+    if (RebuildJournalState(pluginsPath, runs, *run, command == "--undo", names, result, source, error)) {
+        uint64_t checksum = 0;
+        if (!WriteFileWithChecksum(outFile, result, checksum)) {
+            std::cerr << "ERROR: Could not write " << outFile.string() << std::endl;
+            return 1;
+        }
+        std::cout << "Rebuilt JSON " << (command == "--undo" ? "before" : "after") << " run #" << run->id << " ("
+                  << HashText(checksum) << ", " << result.size() << " bytes) from " << source << " to "
+                  << outFile.string() << std::endl;
+        return 0;
+    }
+
+    std::cerr << "ERROR: Could not rebuild the JSON of run #" << run->id << ": " << error << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        DistributionPaths paths;
+        paths.logFilePath = fs::current_path() / "OBody_NG_Preset_Distribution_Assistant-NG.log";
+        bool storeCommand = false;
+        std::string journalCommand;
+        std::string journalRun;
+        std::string extractSequence;
+        fs::path extractFile;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--log" && i + 1 < argc) {
+                paths.logFilePath = argv[++i];
+            } else if (arg == "--list-backups") {
+                storeCommand = true;
+            } else if (arg == "--extract-backup" && i + 2 < argc) {
+                storeCommand = true;
+                extractSequence = argv[++i];
+                extractFile = argv[++i];
+            } else if (arg == "--journal") {
+                journalCommand = arg;
+            } else if ((arg == "--replay" || arg == "--undo") && i + 2 < argc) {
+                journalCommand = arg;
+                journalRun = argv[++i];
+                extractFile = argv[++i];
+            } else if (arg == "--help" || arg == "-h") {
+                PrintUsage();
+                return 0;
+            } else if (paths.dataPath.empty()) {
+                paths.dataPath = arg;
+            } else {
+                PrintUsage();
+                return 2;
+            }
+        }
+
+        if (paths.dataPath.empty() || !fs::is_directory(paths.dataPath)) {
+            std::cerr << "ERROR: Data directory not found: " << paths.dataPath.string() << std::endl;
+            PrintUsage();
+            return 2;
+        }
+
+        if (storeCommand) {
+            return RunBackupStoreCommand(paths.dataPath, extractSequence, extractFile);
+        }
+        if (!journalCommand.empty()) {
+            return RunJournalCommand(paths.dataPath, journalCommand, journalRun, extractFile);
+        }
+
+        DistributionResult result = RunPresetDistribution(paths);
+        std::cout << result.consoleMessage << std::endl;
+        std::cout << "Log: " << paths.logFilePath.string() << std::endl;
+        std::cout << "Report: " << RunReportPath(paths.logFilePath).string() << std::endl;
+        return result.success ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR in PDA_CLI: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "ERROR in PDA_CLI: Unknown exception" << std::endl;
+        return 1;
+    }
+}
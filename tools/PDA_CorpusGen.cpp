@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// ===== GENERADOR DE CORPUS SINTÉTICOS PARA PRUEBAS DE ESCALA =====
+// Escribe en <OutDataDir> un OBody_presetDistributionConfig.json y N archivos OBodyNG_PDA_*.ini con
+// tamaño, reparto por clave, proporción de nombres con escapes y mezcla de modos controlables. Con la
+// misma semilla y las mismas opciones la salida es idéntica byte a byte en cualquier plataforma: sólo se
+// usa mt19937_64 (definido por el estándar) con reducciones propias, nunca las distribuciones de la STL.
+
+const char* const kCorpusKeys[] = {"npcFormID",       "npc",           "factionFemale", "factionMale",
+                                   "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+const size_t kCorpusKeyCount = 8;
+
+// Sufijos de regla admitidos por ParseRuleLine; "count" genera un contador numérico de 1 a 5
+const char* const kModeNames[] = {"x", "x-", "x*", "-", "*", "count", "0", "none"};
+const size_t kModeCount = 8;
+
+struct CorpusOptions {
+    fs::path outDataDir;
+    uint64_t seed = 1;
+    size_t pluginEntries = 50000;  // Entradas plugin -> presets en el JSON, repartidas entre las 8 claves
+    size_t presetPool = 2000;
+    size_t maxPresetsPerPlugin = 4;
+    size_t ruleFiles = 2000;
+    size_t rulesPerFile = 25;
+    double escapeRatio = 0.05;     // Proporción de nombres con comillas, barras, tabuladores o no ASCII
+    double existingPluginRatio = 0.7;  // Reglas que apuntan a plugins ya presentes en el JSON
+    int indent = 4;
+    std::vector<double> keyWeights = std::vector<double>(kCorpusKeyCount, 1.0);
+    std::vector<double> modeWeights = {30, 10, 5, 10, 5, 15, 10, 15};
+};
+
+// ===== ALEATORIEDAD REPRODUCIBLE =====
+
+uint64_t NextBelow(std::mt19937_64& rng, uint64_t bound) {
+    return bound == 0 ? 0 : rng() % bound;
+}
+
+double NextUnit(std::mt19937_64& rng) {
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+size_t PickWeighted(std::mt19937_64& rng, const std::vector<double>& weights) {
+    double total = 0.0;
+    for (double w : weights) total += w;
+    double target = NextUnit(rng) * total;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (target < weights[i]) return i;
+        target -= weights[i];
+    }
+    return weights.size() - 1;
+}
+
+// ===== NOMBRES =====
+
+std::string MakeName(std::mt19937_64& rng, const char* prefix, size_t index, const char* extension,
+                     double escapeRatio) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%06zu", index);
+
+    std::string name;
+    if (NextUnit(rng) < escapeRatio) {
+        // Variantes que obligan a escapar en JSON o que no son ASCII (nunca '|' ni ',': separan campos INI)
+        switch (NextBelow(rng, 5)) {
+            case 0: name = std::string(prefix) + " \"Quoted\" " + number; break;
+            case 1: name = std::string(prefix) + "\\Back\\slash " + number; break;
+            case 2: name = std::string(prefix) + "\tTabbed " + number; break;
+            case 3: name = std::string(prefix) + " \xC3\x9Cn\xC3\xAF" "c\xC3\xB6" "d\xC3\xA9 " + number; break;
+            default: name = std::string(prefix) + " Sl/ash \"Mixed\\\" " + number; break;
+        }
+    } else {
+        name = std::string(prefix) + "_" + number;
+    }
+    return name + extension;
+}
+
+std::string EscapeJsonString(const std::string& str) {
+    std::string result;
+    result.reserve(str.size() + 8);
+    for (unsigned char c : str) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\b': result += "\\b"; break;
+            case '\f': result += "\\f"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    result += buffer;
+                } else {
+                    result += static_cast<char>(c);
+                }
+        }
+    }
+    return result;
+}
+
+// Los tabuladores no sobreviven al Trim del parser INI: en las reglas se sustituyen por espacios
+std::string IniSafeName(std::string name) {
+    std::replace(name.begin(), name.end(), '\t', ' ');
+    return name;
+}
+
+// ===== ESCRITURA =====
+
+bool WriteCorpusFile(const fs::path& filePath, const std::string& content) {
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not create " << filePath.string() << std::endl;
+        return false;
+    }
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return file.good();
+}
+
+bool ParseWeightList(const std::string& value, size_t expected, std::vector<double>& weights) {
+    std::vector<double> parsed;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            parsed.push_back(std::max(0.0, std::stod(item)));
+        } catch (...) {
+            return false;
+        }
+    }
+    if (parsed.size() != expected) return false;
+    weights = parsed;
+    return true;
+}
+
+void PrintUsage() {
+    std::cout << "Usage: PDA_CorpusGen <OutDataDir> [options]" << std::endl;
+    std::cout << "  --seed <N>                 random seed (default 1)" << std::endl;
+    std::cout << "  --plugins <N>              plugin entries in the JSON across all keys (default 50000)" << std::endl;
+    std::cout << "  --presets <N>              size of the preset name pool (default 2000)" << std::endl;
+    std::cout << "  --max-presets <N>          max presets per plugin entry and per rule (default 4)" << std::endl;
+    std::cout << "  --rule-files <N>           OBodyNG_PDA_*.ini files (default 2000)" << std::endl;
+    std::cout << "  --rules-per-file <N>       rules per INI file (default 25)" << std::endl;
+    std::cout << "  --escape-ratio <F>         share of names needing JSON escapes or non-ASCII (default 0.05)"
+              << std::endl;
+    std::cout << "  --existing-ratio <F>       share of rules targeting plugins already in the JSON (default 0.7)"
+              << std::endl;
+    std::cout << "  --key-weights <w1,..,w8>   weights for npcFormID,npc,factionFemale,factionMale," << std::endl;
+    std::cout << "                             npcPluginFemale,npcPluginMale,raceFemale,raceMale" << std::endl;
+    std::cout << "  --mode-mix <w1,..,w8>      weights for x,x-,x*,-,*,count,0,none (default 30,10,5,10,5,15,10,15)"
+              << std::endl;
+    std::cout << "  --indent <N>               JSON indentation width (default 4)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        CorpusOptions options;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--help" || arg == "-h") {
+                PrintUsage();
+                return 0;
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--plugins" && hasValue) {
+                options.pluginEntries = std::stoull(argv[++i]);
+            } else if (arg == "--presets" && hasValue) {
+                options.presetPool = std::max<size_t>(1, std::stoull(argv[++i]));
+            } else if (arg == "--max-presets" && hasValue) {
+                options.maxPresetsPerPlugin = std::max<size_t>(1, std::stoull(argv[++i]));
+            } else if (arg == "--rule-files" && hasValue) {
+                options.ruleFiles = std::stoull(argv[++i]);
+            } else if (arg == "--rules-per-file" && hasValue) {
+                options.rulesPerFile = std::stoull(argv[++i]);
+            } else if (arg == "--escape-ratio" && hasValue) {
+                options.escapeRatio = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+            } else if (arg == "--existing-ratio" && hasValue) {
+                options.existingPluginRatio = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+            } else if (arg == "--indent" && hasValue) {
+                options.indent = std::clamp(std::stoi(argv[++i]), 1, 8);
+            } else if (arg == "--key-weights" && hasValue) {
+                if (!ParseWeightList(argv[++i], kCorpusKeyCount, options.keyWeights)) {
+                    std::cerr << "ERROR: --key-weights needs 8 comma-separated numbers" << std::endl;
+                    return 2;
+                }
+            } else if (arg == "--mode-mix" && hasValue) {
+                if (!ParseWeightList(argv[++i], kModeCount, options.modeWeights)) {
+                    std::cerr << "ERROR: --mode-mix needs 8 comma-separated numbers" << std::endl;
+                    return 2;
+                }
+            } else if (options.outDataDir.empty()) {
+                options.outDataDir = arg;
+            } else {
+                PrintUsage();
+                return 2;
+            }
+        }
+
+        if (options.outDataDir.empty()) {
+            PrintUsage();
+            return 2;
+        }
+
+        std::mt19937_64 rng(options.seed);
+        fs::path sksePluginsPath = options.outDataDir / "SKSE" / "Plugins";
+        fs::create_directories(sksePluginsPath);
+
+        // Pool de presets compartido por el JSON y las reglas
+        std::vector<std::string> presetNames;
+        presetNames.reserve(options.presetPool);
+        for (size_t i = 0; i < options.presetPool; ++i) {
+            presetNames.push_back(MakeName(rng, "Preset", i, "", options.escapeRatio));
+        }
+
+        // Plugins por clave: cada entrada recibe un nombre único dentro de su clave
+        std::vector<std::vector<std::string>> keyPlugins(kCorpusKeyCount);
+        for (size_t i = 0; i < options.pluginEntries; ++i) {
+            size_t key = PickWeighted(rng, options.keyWeights);
+            keyPlugins[key].push_back(MakeName(rng, "Mod", i, ".esp", options.escapeRatio));
+        }
+
+        // ===== JSON =====
+        const std::string pad1(options.indent, ' ');
+        const std::string pad2(options.indent * 2, ' ');
+        const std::string pad3(options.indent * 3, ' ');
+
+        std::string json;
+        json.reserve(options.pluginEntries * (48 + options.maxPresetsPerPlugin * 24) + 1024);
+        json += "{\n";
+        for (size_t key = 0; key < kCorpusKeyCount; ++key) {
+            json += pad1 + "\"" + kCorpusKeys[key] + "\": {";
+            const auto& plugins = keyPlugins[key];
+            if (plugins.empty()) {
+                json += "},\n";
+                continue;
+            }
+            json += "\n";
+            for (size_t p = 0; p < plugins.size(); ++p) {
+                json += pad2 + "\"" + EscapeJsonString(plugins[p]) + "\": [\n";
+                size_t presetCount = 1 + NextBelow(rng, options.maxPresetsPerPlugin);
+                for (size_t s = 0; s < presetCount; ++s) {
+                    const std::string& preset = presetNames[NextBelow(rng, presetNames.size())];
+                    json += pad3 + "\"" + EscapeJsonString(preset) + "\"";
+                    json += (s + 1 < presetCount) ? ",\n" : "\n";
+                }
+                json += pad2 + "]";
+                json += (p + 1 < plugins.size()) ? ",\n" : "\n";
+            }
+            json += pad1 + "},\n";
+        }
+        json += pad1 + "\"blacklistedNpcs\": [],\n";
+        json += pad1 + "\"blacklistedOutfitsFromORefitPlugin\": {}\n";
+        json += "}";
+
+        if (!WriteCorpusFile(sksePluginsPath / "OBody_presetDistributionConfig.json", json)) return 1;
+
+        // ===== ARCHIVOS DE REGLAS =====
+        size_t totalRules = 0;
+        std::vector<size_t> modeTotals(kModeCount, 0);
+        for (size_t f = 0; f < options.ruleFiles; ++f) {
+            std::string ini;
+            ini.reserve(options.rulesPerFile * 96 + 64);
+            ini += "; OBody PDA synthetic corpus - file " + std::to_string(f) + " (seed " +
+                   std::to_string(options.seed) + ")\n";
+
+            for (size_t r = 0; r < options.rulesPerFile; ++r) {
+                size_t key = PickWeighted(rng, options.keyWeights);
+                size_t mode = PickWeighted(rng, options.modeWeights);
+                modeTotals[mode]++;
+                totalRules++;
+
+                std::string plugin;
+                if (!keyPlugins[key].empty() && NextUnit(rng) < options.existingPluginRatio) {
+                    plugin = keyPlugins[key][NextBelow(rng, keyPlugins[key].size())];
+                } else {
+                    plugin = MakeName(rng, "NewMod", f * options.rulesPerFile + r, ".esp", options.escapeRatio);
+                }
+
+                std::string modeName = kModeNames[mode];
+                bool removal = modeName == "-" || modeName == "x-";
+                size_t presetCount = 1 + NextBelow(rng, options.maxPresetsPerPlugin);
+                std::string presets;
+                for (size_t s = 0; s < presetCount; ++s) {
+                    if (s > 0) presets += ", ";
+                    if (removal && NextBelow(rng, 2) == 0) presets += "!";
+                    presets += IniSafeName(presetNames[NextBelow(rng, presetNames.size())]);
+                }
+
+                ini += kCorpusKeys[key];
+                ini += " = ";
+                ini += IniSafeName(plugin);
+                ini += '|';
+                ini += presets;
+                if (modeName == "count") {
+                    ini += '|';
+                    ini += std::to_string(1 + NextBelow(rng, 5));
+                } else if (modeName != "none") {
+                    ini += '|';
+                    ini += modeName;
+                }
+                ini += '\n';
+            }
+
+            char filename[64];
+            std::snprintf(filename, sizeof(filename), "OBodyNG_PDA_Corpus_%05zu.ini", f);
+            if (!WriteCorpusFile(options.outDataDir / filename, ini)) return 1;
+        }
+
+        // Ajustes del plugin: sin backup y sin caché de ejecución, para que cada pasada sea completa
+        if (!WriteCorpusFile(sksePluginsPath / "OBody_NG_Preset_Distribution_Assistant_NG.ini",
+                             "[Original backup]\nBackup = 0\n\n[Run cache]\nForceRun = true\n")) {
+            return 1;
+        }
+
+        std::cout << "Corpus written to: " << options.outDataDir.string() << " (seed " << options.seed << ")"
+                  << std::endl;
+        std::cout << "JSON: " << json.size() << " bytes, " << options.pluginEntries << " plugin entries" << std::endl;
+        for (size_t key = 0; key < kCorpusKeyCount; ++key) {
+            std::cout << "  " << kCorpusKeys[key] << ": " << keyPlugins[key].size() << std::endl;
+        }
+        std::cout << "Rule files: " << options.ruleFiles << ", rules: " << totalRules << std::endl;
+        for (size_t mode = 0; mode < kModeCount; ++mode) {
+            std::cout << "  " << kModeNames[mode] << ": " << modeTotals[mode] << std::endl;
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR in PDA_CorpusGen: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "ERROR in PDA_CorpusGen: Unknown exception" << std::endl;
+        return 1;
+    }
+}